@@ -0,0 +1,384 @@
+#ifndef BUSCA_ITERATIVA_H
+#define BUSCA_ITERATIVA_H
+
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+#include <unordered_map>
+#include "instrumentacao.h"
+#include "mascara.h"
+#include "candidatos.h"
+
+using namespace std;
+
+// Busca em profundidade iterativa usada pelos solvers de Global/.
+//
+// Em vez de empilhar pares (índice, opção) num std::stack e copiar vector<int> para dentro e para fora de
+// combinacaoAtual, cada rota candidata vira um registro de tamanho fixo (máscara dos clientes, custo e
+// carga, calculados uma única vez) e a pilha guarda quadros de 16 bytes com tudo o que a busca precisa
+// para continuar daquele ponto. A pilha e o caminho (índices das rotas escolhidas) são alocados uma vez
+// por thread, então o laço principal não aloca nada e a melhor combinação é copiada só como índices.
+// A busca procura coberturas dos clientes (como a versão original, um cliente pode aparecer em mais de uma
+// rota) escolhendo sempre uma rota que passa pelo menor cliente ainda não atendido, então a pilha nunca passa
+// de n + 1 quadros. Uma rota só precisa repetir clientes já atendidos se algum subconjunto dela custa mais que
+// ela (ver IndexarRotas); com a desigualdade triangular isso não acontece e a busca vira uma busca por
+// partições. Com --particao (IndiceRotas sem sobreposições) cada cliente fica em exatamente uma rota.
+// Tudo é especializado pelo tipo da máscara de clientes (ver mascara.h), e a pilha de cada thread é um
+// array de tamanho fixo BitsMascara<Mascara>() + 1.
+
+template <typename Mascara>
+struct RotaCompacta {
+    Mascara mascara;  // bit j ligado = locais[j] está na rota
+    int custo;        // custo da rota saindo e voltando ao depósito
+    int carga;        // soma das demandas dos clientes da rota
+};
+
+// Vista só de leitura de uma tabela de rotas compactas: o vector montado por CompactarRotas ou o arquivo
+// mapeado em memória de rotasDisco.h. A busca só lê a tabela, então não precisa saber de onde ela vem.
+template <typename Mascara>
+struct TabelaRotas {
+    const RotaCompacta<Mascara>* rotas = nullptr;
+    size_t tamanho = 0;
+
+    TabelaRotas() {}
+    TabelaRotas(const RotaCompacta<Mascara>* r, size_t n) : rotas(r), tamanho(n) {}
+    TabelaRotas(const vector<RotaCompacta<Mascara>>& v) : rotas(v.data()), tamanho(v.size()) {}
+
+    size_t size() const { return tamanho; }
+    const RotaCompacta<Mascara>* data() const { return rotas; }
+    const RotaCompacta<Mascara>& operator[](size_t i) const { return rotas[i]; }
+    const RotaCompacta<Mascara>* begin() const { return rotas; }
+    const RotaCompacta<Mascara>* end() const { return rotas + tamanho; }
+};
+
+template <typename Mascara>
+struct Quadro {
+    Mascara coberto;  // clientes já atendidos pelas rotas escolhidas
+    int proximo;      // próxima rota candidata para o menor cliente ainda não atendido (ver continuarBusca)
+    int profundidade; // quantas rotas já foram escolhidas (posição livre em caminho)
+    int custo;        // custo das rotas escolhidas
+};
+
+// Prefixo de rotas já escolhidas que define uma tarefa independente da busca
+template <typename Mascara>
+struct Tarefa {
+    Mascara coberto;
+    int prefixo[2];
+    int tamanho;
+    int custo;
+};
+
+// Pilha e caminho de tamanho fixo de uma thread (n nunca passa do número de bits da máscara)
+template <typename Mascara>
+struct EspacoBusca {
+    Quadro<Mascara> pilha[BitsMascara<Mascara>() + 1];
+    int caminho[BitsMascara<Mascara>() + 1];
+};
+
+// Converte as rotas (já reduzidas e ordenadas por ReduzirCandidatos) para a representação compacta
+template <typename Mascara>
+vector<RotaCompacta<Mascara>> CompactarRotas(const vector<vector<int>>& rotas, const vector<int>& locais, map<int,int>& demanda,
+                                             const MatrizCustos& m, int deposito) {
+    map<int,int> bit;
+    for (int j = 0; j < (int) locais.size(); j++) {
+        bit[locais[j]] = j;
+    }
+    vector<RotaCompacta<Mascara>> compactas;
+    compactas.reserve(rotas.size());
+    for (const auto& rota : rotas) {
+        RotaCompacta<Mascara> r = {0, m.custoRota(rota, deposito), 0};
+        for (int cidade : rota) {
+            r.mascara |= Mascara(1) << bit[cidade];
+            r.carga += demanda[cidade];
+        }
+        compactas.push_back(r);
+    }
+    return compactas;
+}
+
+// inicio[c] é a primeira rota cujo menor cliente é c ou maior (as rotas estão ordenadas por menor cliente);
+// inicio[n] = número de rotas. A busca binária só lê poucos registros, o que importa com a tabela em disco.
+template <typename Mascara>
+vector<int> InicioPorCliente(TabelaRotas<Mascara> rotas, int n) {
+    vector<int> inicio(n + 1);
+    for (int c = 0; c <= n; c++) {
+        inicio[c] = partition_point(rotas.begin(), rotas.end(), [c](const RotaCompacta<Mascara>& r) {
+            return MenorBit(r.mascara) < c;
+        }) - rotas.begin();
+    }
+    return inicio;
+}
+
+// Onde a busca procura as rotas que atendem o menor cliente c ainda não atendido: o grupo de c
+// (inicio[c] .. inicio[c + 1] - 1), em que só as rotas marcadas em "sobrepoe" podem repetir clientes já
+// atendidos, e depois as rotas de "outras[c]", que passam por c mas começam por um cliente menor (já atendido).
+// Na partição (ou quando nenhuma rota precisa sobrepor) sobrepoe, outras e posicao ficam vazios.
+//
+// Uma rota R que repete os clientes já atendidos A pode ser trocada por R - A sempre que essa rota está na
+// tabela com custo menor ou igual: a cobertura continua completa, não fica mais cara, e R - A começa por c.
+// Isso é conferido em dois níveis: IndexarRotas marca em "sobrepoe" só as rotas em que a troca pode falhar
+// para algum A, e durante a busca precisaSobrepor confere o A do nó.
+template <typename Mascara>
+struct IndiceRotas {
+    vector<int> inicio;
+    vector<char> sobrepoe;
+    vector<vector<int>> outras;               // em ordem crescente de custo, como os grupos
+    unordered_map<Mascara, int, HashMascara> posicao; // máscara -> rota da tabela
+
+    bool precisaSobrepor(const RotaCompacta<Mascara>* r, int i, Mascara coberto) const {
+        auto it = posicao.find(Mascara(r[i].mascara & ~coberto));
+        return it == posicao.end() || r[it->second].custo > r[i].custo;
+    }
+};
+
+// A troca nunca falha se R é "monótona": cada R - {x} está na tabela, custa no máximo R e também é
+// monótona, o que é conferido tirando um cliente por vez. Um subconjunto fora da tabela (sem aresta entre
+// clientes seguidos, ou removido por dominância) conta como falha. Com a desigualdade triangular e as rotas
+// na melhor ordem toda rota é monótona.
+template <typename Mascara>
+IndiceRotas<Mascara> IndexarRotas(TabelaRotas<Mascara> rotas, int n, bool particao) {
+    IndiceRotas<Mascara> indice;
+    indice.inicio = InicioPorCliente(rotas, n);
+    if (particao) {
+        return indice;
+    }
+    unordered_map<Mascara, int, HashMascara>& posicao = indice.posicao;
+    posicao.reserve(rotas.size());
+    vector<int> ordem(rotas.size());
+    for (int i = 0; i < (int) rotas.size(); i++) {
+        posicao[rotas[i].mascara] = i;
+        ordem[i] = i;
+    }
+    // os subconjuntos de uma rota são decididos antes dela
+    stable_sort(ordem.begin(), ordem.end(), [&rotas](int a, int b) {
+        return ContarBits(rotas[a].mascara) < ContarBits(rotas[b].mascara);
+    });
+    vector<char> monotona(rotas.size(), 0);
+    indice.sobrepoe.assign(rotas.size(), 0);
+    indice.outras.assign(n, {});
+    int sobrepostas = 0;
+    for (int i : ordem) {
+        bool ok = true;
+        for (Mascara resto = rotas[i].mascara; resto != 0 && ok; resto &= resto - 1) {
+            Mascara sub = rotas[i].mascara ^ (resto & (~resto + 1));
+            if (sub == 0) {
+                continue;
+            }
+            auto it = posicao.find(sub);
+            ok = it != posicao.end() && monotona[it->second] && rotas[it->second].custo <= rotas[i].custo;
+        }
+        monotona[i] = ok;
+        if (ok) {
+            continue;
+        }
+        indice.sobrepoe[i] = 1;
+        sobrepostas++;
+        Mascara menor = rotas[i].mascara & (~rotas[i].mascara + 1);
+        for (Mascara resto = rotas[i].mascara ^ menor; resto != 0; resto &= resto - 1) {
+            indice.outras[MenorBit(resto)].push_back(i);
+        }
+    }
+    // sem nenhuma rota que precise sobrepor, a busca fica igual à da partição
+    if (sobrepostas == 0) {
+        indice.sobrepoe.clear();
+        indice.outras.clear();
+        posicao.clear();
+        return indice;
+    }
+    for (auto& lista : indice.outras) {
+        stable_sort(lista.begin(), lista.end(), [&rotas](int a, int b) {
+            return rotas[a].custo < rotas[b].custo;
+        });
+    }
+    return indice;
+}
+
+// Tarefas da busca. Sem divisão a tarefa i é só a rota inicio[0] + i, montada do registro da tabela quando é
+// pedida, então nada fica guardado por tarefa (com a tabela em disco o grupo do cliente 0 tem quase todas as
+// rotas). Só as tarefas divididas, que aparecem quando esse grupo é pequeno, ficam numa lista.
+template <typename Mascara>
+struct ListaTarefas {
+    int primeira = 0;                 // primeira rota do grupo do cliente 0
+    int quantidade = 0;               // rotas do grupo do cliente 0
+    bool divididas = false;
+    vector<Tarefa<Mascara>> lista;    // só com divididas
+
+    int size() const {
+        return divididas ? (int) lista.size() : quantidade;
+    }
+
+    Tarefa<Mascara> tarefa(TabelaRotas<Mascara> rotas, int i) const {
+        if (divididas) {
+            return lista[i];
+        }
+        const RotaCompacta<Mascara>& r = rotas[primeira + i];
+        return {r.mascara, {primeira + i, -1}, 1, r.custo};
+    }
+};
+
+// A busca começa sempre por uma rota com o cliente 0, então as rotas desse grupo dividem o espaço de busca.
+// Se isso der poucas tarefas para os trabalhadores, cada uma é dividida de novo pela rota que atende o menor
+// cliente restante.
+template <typename Mascara>
+ListaTarefas<Mascara> GerarTarefas(TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice, Mascara todas, int frota, int minimo) {
+    const vector<int>& inicio = indice.inicio;
+    ListaTarefas<Mascara> tarefas;
+    tarefas.primeira = inicio[0];
+    tarefas.quantidade = inicio[1] - inicio[0];
+    if (tarefas.quantidade >= minimo || frota == 1) {
+        return tarefas;
+    }
+    tarefas.divididas = true;
+    for (int i = inicio[0]; i < inicio[1]; i++) {
+        Tarefa<Mascara> t = {rotas[i].mascara, {i, -1}, 1, rotas[i].custo};
+        if (t.coberto == todas) {
+            tarefas.lista.push_back(t);
+            continue;
+        }
+        int c = MenorBit(Mascara(~t.coberto & todas));
+        for (int j = inicio[c]; j < inicio[c + 1]; j++) {
+            if ((rotas[j].mascara & t.coberto) == 0 ||
+                (!indice.sobrepoe.empty() && indice.sobrepoe[j] && indice.precisaSobrepor(rotas.data(), j, t.coberto))) {
+                tarefas.lista.push_back({Mascara(t.coberto | rotas[j].mascara), {i, j}, 2, t.custo + rotas[j].custo});
+            }
+        }
+        if (!indice.sobrepoe.empty()) {
+            for (int j : indice.outras[c]) {
+                if (!indice.precisaSobrepor(rotas.data(), j, t.coberto)) {
+                    continue;
+                }
+                tarefas.lista.push_back({Mascara(t.coberto | rotas[j].mascara), {i, j}, 2, t.custo + rotas[j].custo});
+            }
+        }
+    }
+    return tarefas;
+}
+
+// Observador padrão da busca: não faz nada, e o compilador remove a chamada do laço. O ponto de controle
+// (checkpoint.h) usa o mesmo gancho para gravar a pilha de tempos em tempos.
+struct SemPontoControle {
+    template <typename Espaco>
+    bool no(const Espaco&, int, int, const vector<int>&) {
+        return false;
+    }
+};
+
+// Continua a busca a partir dos "topo" quadros que já estão em espaco.pilha (e do caminho até eles).
+// Devolve false se o observador pediu para parar; nesse caso a pilha fica como estava no último nó.
+template <typename Mascara, typename PontoControle>
+bool continuarBusca(TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice, Mascara todas, int frota,
+                    EspacoBusca<Mascara>& espaco, int topo, int& melhorCusto, vector<int>& melhorCaminho, PontoControle& pc) {
+    INSTR_LOCAL(ct);
+    INSTR_CRONOMETRO_THREAD(ct);
+    const RotaCompacta<Mascara>* r = rotas.data();
+    Quadro<Mascara>* pilha = espaco.pilha;
+    int* caminho = espaco.caminho;
+    const int* inicio = indice.inicio.data();
+    const char* sobrepoe = indice.sobrepoe.empty() ? nullptr : indice.sobrepoe.data();
+    int limiteRotas = frota > 0 ? frota : INT_MAX;
+
+    while (topo > 0) {
+        if (pc.no(espaco, topo, melhorCusto, melhorCaminho)) {
+            return false;
+        }
+        // o quadro do topo é atualizado no lugar: ele guarda onde continuar quando o filho terminar
+        Quadro<Mascara>& q = pilha[topo - 1];
+        INSTR_NO(ct);
+        // q.proximo percorre o grupo do cliente c e depois, a partir de fimGrupo, as posições de outras[c]
+        int c = MenorBit(Mascara(~q.coberto & todas));
+        int fimGrupo = inicio[c + 1];
+        int escolhida = -1;
+        int i = q.proximo;
+        for (; i < fimGrupo; i++) {
+            if (q.custo + r[i].custo >= melhorCusto) {
+                INSTR_CONTA(ct, PODAS);
+                i = fimGrupo;
+                break;
+            }
+            if ((r[i].mascara & q.coberto) == 0 || (sobrepoe && sobrepoe[i] && indice.precisaSobrepor(r, i, q.coberto))) {
+                escolhida = i;
+                q.proximo = i + 1;
+                break;
+            }
+        }
+        if (escolhida < 0 && sobrepoe) {
+            const vector<int>& outras = indice.outras[c];
+            for (; i - fimGrupo < (int) outras.size(); i++) {
+                int j = outras[i - fimGrupo];
+                if (q.custo + r[j].custo >= melhorCusto) {
+                    INSTR_CONTA(ct, PODAS);
+                    break;
+                }
+                if (indice.precisaSobrepor(r, j, q.coberto)) {
+                    escolhida = j;
+                    q.proximo = i + 1;
+                    break;
+                }
+            }
+        }
+        if (escolhida < 0) {
+            topo--;
+            continue;
+        }
+        caminho[q.profundidade] = escolhida;
+        Mascara coberto = q.coberto | r[escolhida].mascara;
+        int custo = q.custo + r[escolhida].custo;
+        INSTR_CONTA(ct, COBERTURAS_TESTADAS);
+        if (coberto == todas) {
+            INSTR_CONTA(ct, COBERTURAS_OK);
+            INSTR_CONTA(ct, ATUALIZACOES_INCUMBENTE);
+            melhorCusto = custo;
+            melhorCaminho.assign(caminho, caminho + q.profundidade + 1);
+            continue;
+        }
+        // com a frota esgotada este filho não conseguiria atender o resto dos clientes
+        if (q.profundidade + 1 >= limiteRotas) {
+            INSTR_CONTA(ct, PODAS);
+            continue;
+        }
+        pilha[topo++] = {coberto, inicio[MenorBit(Mascara(~coberto & todas))], q.profundidade + 1, custo};
+    }
+    return true;
+}
+
+// Procura a melhor cobertura dos clientes por rotas candidatas que começa pelo prefixo da tarefa. A cada passo
+// só são tentadas as rotas que passam pelo menor cliente ainda não atendido; das que começam por ele, só as
+// que não repetem clientes ou que precisam sobrepor (ver IndiceRotas), e das que começam antes, só as que
+// precisam sobrepor. Sem sobreposição cada conjunto de rotas aparece numa única ordem. Dentro de cada grupo (e de cada
+// lista outras[c]) as rotas estão em ordem crescente de custo, então a primeira que estoura o limite encerra
+// a lista. Com frota > 0, nenhum ramo usa mais que "frota" rotas.
+// melhorCusto funciona também como limite: só soluções estritamente melhores são aceitas.
+template <typename Mascara, typename PontoControle>
+bool buscarCoberturas(TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice, const Tarefa<Mascara>& tarefa, Mascara todas,
+                      int frota, EspacoBusca<Mascara>& espaco, int& melhorCusto, vector<int>& melhorCaminho, PontoControle& pc) {
+    INSTR_LOCAL(ct);
+    for (int k = 0; k < tarefa.tamanho; k++) {
+        espaco.caminho[k] = tarefa.prefixo[k];
+    }
+    INSTR_CONTA(ct, COBERTURAS_TESTADAS);
+    if (tarefa.coberto == todas) {
+        if (tarefa.custo < melhorCusto) {
+            INSTR_CONTA(ct, COBERTURAS_OK);
+            INSTR_CONTA(ct, ATUALIZACOES_INCUMBENTE);
+            melhorCusto = tarefa.custo;
+            melhorCaminho.assign(espaco.caminho, espaco.caminho + tarefa.tamanho);
+        }
+        return true;
+    }
+    if (frota > 0 && tarefa.tamanho >= frota) {
+        return true;
+    }
+    espaco.pilha[0] = {tarefa.coberto, indice.inicio[MenorBit(Mascara(~tarefa.coberto & todas))], tarefa.tamanho, tarefa.custo};
+    return continuarBusca(rotas, indice, todas, frota, espaco, 1, melhorCusto, melhorCaminho, pc);
+}
+
+template <typename Mascara>
+bool buscarCoberturas(TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice, const Tarefa<Mascara>& tarefa, Mascara todas,
+                      int frota, EspacoBusca<Mascara>& espaco, int& melhorCusto, vector<int>& melhorCaminho) {
+    SemPontoControle pc;
+    return buscarCoberturas(rotas, indice, tarefa, todas, frota, espaco, melhorCusto, melhorCaminho, pc);
+}
+
+#endif
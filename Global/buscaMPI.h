@@ -0,0 +1,318 @@
+#ifndef BUSCA_MPI_H
+#define BUSCA_MPI_H
+
+// mpi.h vem antes de cacheInstancias.h, que só declara as variantes MPI com MPI_VERSION definido
+#include <mpi.h>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <climits>
+#include <chrono>
+#include <memory>
+#include "instrumentacao.h"
+#include "buscaIterativa.h"
+#include "candidatos.h"
+#include "opcoes.h"
+#include "incremental.h"
+#include "checkpoint.h"
+#include "cacheInstancias.h"
+#include "relaxacao.h"
+
+using namespace std;
+
+// Parte comum dos dois solvers MPI (globalSearch.cpp e globalSearchMPI.cpp): leitura da instância, cache,
+// geração e redução das rotas e busca nas tarefas de cada processo. Os programas só diferem em como o melhor
+// resultado dos processos chega ao rank 0 e na linha do custo final, que o benchmark lê dos dois jeitos.
+
+// O que cada programa define. "juntar" recebe o melhor custo e o caminho (índices em "rotas", que são as
+// mesmas em todos os processos) de cada processo e deixa o melhor de todos no rank 0.
+struct ProgramaMPI {
+    const char* rotuloCusto;  // "Menor custo: " ou "Custo total: "
+    void (*juntar)(int rank, int size, int& custo, vector<int>& caminho);
+    bool gravarTempo;         // grava também tempo_execucao_<instância>.txt
+};
+
+inline void LerGrafo(const string& file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes) {
+    ifstream arquivo;
+    arquivo.open(file);
+    if (arquivo.is_open()) {
+        arquivo >> numNos;
+        // Populando a lista de demandas dos locais
+        for (int i = 0; i < numNos - 1; i++) {
+            int id_no, demanda_no;
+            arquivo >> id_no;
+            arquivo >> demanda_no;
+            demanda[id_no] = demanda_no;
+        }
+        int K; // número de arestas
+        arquivo >> K;
+        for (int i = 0; i < K; i++) {
+            int id_no1, id_no2, custo;
+            arquivo >> id_no1;
+            arquivo >> id_no2;
+            arquivo >> custo;
+            arestas.push_back(make_tuple(id_no1, id_no2, custo));
+        }
+        LerParametrosArquivo(arquivo, opcoes);
+    }
+    arquivo.close();
+}
+
+// Redução das rotas e busca nas tarefas deste processo, com clientes representados em máscaras do tipo Mascara.
+// Devolve 0 se a busca terminou, 1 em caso de erro no checkpoint e 2 se ela foi interrompida por um sinal
+// (com o checkpoint deste processo gravado).
+template <typename Mascara>
+int BuscarNoProcesso(vector<vector<int>>& rotas, const vector<int>& locais, map<int, int>& demanda, const MatrizCustos& matriz,
+                     int deposito, int frota, CacheOrdens* cache, const Opcoes& opcoes, int rank, int size,
+                     int& melhorCustoLocal, vector<int>& melhorCaminhoLocal, LimiteLP& relaxacao) {
+    // remove rotas dominadas e coloca cada rota na sua melhor ordem antes da busca
+    ReduzirCandidatos<Mascara>(rotas, locais, matriz, deposito, frota > 0, cache);
+    if (rank == 0) {
+        cout << "Rotas apos reducao: " << rotas.size() << endl;
+    }
+
+    vector<RotaCompacta<Mascara>> compactas = CompactarRotas<Mascara>(rotas, locais, demanda, matriz, deposito);
+    // todos os processos resolvem o mesmo LP e chegam às mesmas rotas, na mesma ordem
+    if (opcoes.relaxacao) {
+        relaxacao = AplicarRelaxacao(rotas, compactas, locais.size(), frota, melhorCustoLocal, rank == 0);
+    }
+    TabelaRotas<Mascara> tabela(compactas);
+    Mascara todas = MascaraTodos<Mascara>(locais.size());
+    IndiceRotas<Mascara> indice = IndexarRotas(tabela, locais.size(), opcoes.particao);
+    // ao retomar, as tarefas precisam ser as mesmas da execução que gravou o checkpoint, mesmo com outro número de processos
+    bool usarCheckpoint = !opcoes.checkpoint.empty();
+    int minimoTarefas = 4 * size;
+    if (opcoes.retomar) {
+        minimoTarefas = MinimoTarefasSalvo(opcoes.checkpoint, ".r", minimoTarefas);
+    }
+    ListaTarefas<Mascara> tarefas = GerarTarefas(tabela, indice, todas, frota, minimoTarefas);
+
+    // cada processo grava o seu próprio arquivo; ao retomar, todos leem os arquivos antes de o rank 0 juntá-los
+    // na base e apagá-los
+    Retomada<Mascara> retomada;
+    unique_ptr<PontoControle<Mascara>> pc;
+    if (usarCheckpoint) {
+        CabecalhoCheckpoint cabecalho = CabecalhoEsperado(tabela, indice, tarefas, minimoTarefas);
+        int erro = 0;
+        vector<string> lidos;
+        if (opcoes.retomar && !CarregarRetomada(opcoes.checkpoint, ".r", cabecalho, retomada, lidos)) {
+            erro = 1;
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &erro, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        if (erro) {
+            return 1;
+        }
+        if (rank == 0) {
+            if (opcoes.retomar) {
+                erro = !ConsolidarRetomada(opcoes.checkpoint, retomada, lidos);
+                cout << "Checkpoint: " << retomada.concluida.quantidade() << " tarefas concluidas, "
+                     << retomada.parciais.size() << " interrompidas, " << retomada.nos << " nos ja explorados" << endl;
+            } else {
+                RemoverCheckpoint(opcoes.checkpoint, ".r");
+            }
+        }
+        MPI_Bcast(&erro, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (erro) {
+            return 1;
+        }
+        if (retomada.melhorCusto < melhorCustoLocal) {
+            melhorCustoLocal = retomada.melhorCusto;
+            melhorCaminhoLocal = retomada.melhorCaminho;
+        }
+        pc.reset(new PontoControle<Mascara>(opcoes.checkpoint + ".r" + to_string(rank), cabecalho, opcoes.intervaloCheckpoint));
+        InstalarSinalParada();
+    }
+    TarefasPendentes<Mascara> pendentes(retomada, tarefas.size());
+    int totalTarefas = pendentes.size();
+
+    // pilha e caminho de tamanho fixo, alocados uma vez para todas as tarefas
+    unique_ptr<EspacoBusca<Mascara>> espaco(new EspacoBusca<Mascara>);
+    // cada processo fica com as tarefas rank, rank + size, rank + 2*size, ...
+    // As primeiras tarefas (rotas mais baratas) costumam ter as maiores subárvores, então distribuir de forma intercalada equilibra melhor
+    // a carga do que dar um bloco contíguo para cada processo
+    for (int i = rank; i < totalTarefas && !pararSolicitado; i += size) {
+        ExecutarTarefa(tabela, indice, tarefas, todas, frota, retomada, pendentes[i], *espaco, melhorCustoLocal, melhorCaminhoLocal, pc.get());
+    }
+    if (pc) {
+        pc->finalizar();
+    }
+    if (melhorCustoLocal < INT_MAX) {
+        melhorCustoLocal += relaxacao.deslocamento;
+    }
+    return pararSolicitado ? 2 : 0;
+}
+
+// Tudo o que o main dos solvers MPI faz entre MPI_Init e MPI_Finalize. Devolve o código de saída.
+inline int ExecutarProgramaMPI(int argc, char* argv[], const ProgramaMPI& programa) {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    INSTR_MPI_INIT(rank, size);
+    auto start = std::chrono::high_resolution_clock::now();
+    Opcoes opcoes;
+    if (!LerOpcoes(argc, argv, opcoes)) {
+        if (rank == 0) {
+            ImprimirUso(argv[0]);
+        }
+        return 1;
+    }
+    // cada processo precisaria da tabela inteira e a solução é trocada por índices das rotas na memória
+    if (!opcoes.rotasDisco.empty()) {
+        if (rank == 0) {
+            cout << "--rotas-disco so existe no solver OpenMP" << endl;
+        }
+        return 1;
+    }
+    if (!ConferirParticao(opcoes).empty()) {
+        if (rank == 0) {
+            cout << ConferirParticao(opcoes) << endl;
+        }
+        return 1;
+    }
+    map<int, int> demanda;
+    vector<tuple<int, int, int>> arestas;
+
+    INSTR_FASE(faseLeitura, LEITURA);
+    // a instância vem do arquivo ou, na reotimização incremental, do estado salvo com o delta aplicado
+    EstadoResolvido estado;
+    int numNos = 0;
+    if (!opcoes.estado.empty()) {
+        if (!CarregarEstado(opcoes, estado)) {
+            return 1;
+        }
+        demanda = estado.demanda;
+        arestas = estado.arestas;
+        numNos = estado.numNos;
+    } else {
+        LerGrafo(opcoes.arquivo, demanda, arestas, numNos, opcoes);
+    }
+    INSTR_FASE_FIM(faseLeitura);
+    AplicarPadroes(opcoes, 10);
+    vector<int> locais = ClientesSemDeposito(numNos, opcoes.deposito);
+    // o cache das ordens só é mantido quando vai ser reaproveitado ou gravado
+    CacheOrdens* cache = opcoes.estado.empty() && opcoes.salvarEstado.empty() ? nullptr : &estado.cache;
+    int capacidade = opcoes.capacidade;
+    int deposito = opcoes.deposito;
+    int frota = opcoes.frota;
+
+    if (rank == 0) {
+        cout << "Local: " << locais.size() << endl;
+    }
+
+    INSTR_FASE(faseGeracao, GERACAO);
+    MatrizCustos matriz(numNos, arestas);
+    // a mesma instância (mesmo que com outra numeração dos clientes) já pode ter sido resolvida; só o rank 0
+    // consulta o cache e a resposta dele vale para todos
+    ChaveInstancia chave = CalcularChave(opcoes.cache, numNos, demanda, capacidade, deposito, matriz);
+    vector<vector<int>> solucaoCache;
+    int custoCache;
+    if (LerSolucaoCacheMPI(chave, frota, opcoes.particao, matriz, deposito, solucaoCache, custoCache, rank)) {
+        if (rank == 0) {
+            cout << "Cache: solucao encontrada" << endl;
+            ImprimirRotas(solucaoCache, matriz, deposito);
+            cout << programa.rotuloCusto << custoCache << endl;
+            if (!opcoes.salvarEstado.empty()) {
+                SalvarExecucao(opcoes, numNos, demanda, arestas, solucaoCache, estado);
+            }
+            std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+            std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
+        }
+        INSTR_FINALIZAR_MPI(rank, size);
+        return 0;
+    }
+    vector<vector<int>> rotas;
+    if (LerRotasCacheMPI(chave, frota > 0, rotas, estado.cache, matriz, deposito, rank)) {
+        if (rank == 0) {
+            cout << "Cache: tabela de rotas encontrada" << endl;
+        }
+        cache = &estado.cache;
+    } else {
+        rotas = GerarRotasCandidatas(locais, demanda, capacidade, matriz);
+    }
+    INSTR_FASE_FIM(faseGeracao);
+
+    if (rank == 0) {
+        cout << "Rotas: " << rotas.size() << endl;
+    }
+
+    vector<int> melhorCaminho;
+    // na reotimização, a solução anterior (se continua válida) já limita a busca desde o começo
+    int melhorCusto = LimiteInicial(estado, locais, demanda, opcoes, matriz, rank == 0);
+    LimiteLP relaxacao;
+
+    // a redução e a busca são compiladas para cada tipo de máscara e rodam com o menor em que cabem os clientes
+    INSTR_FASE(faseBusca, BUSCA);
+    int resultado = 0;
+    bool cabe = DespacharPorTamanho(locais.size(), [&](auto zero) {
+        resultado = BuscarNoProcesso<decltype(zero)>(rotas, locais, demanda, matriz, deposito, frota, cache, opcoes, rank, size,
+                                                     melhorCusto, melhorCaminho, relaxacao);
+    });
+    INSTR_FASE_FIM(faseBusca);
+    if (!cabe) {
+        if (rank == 0) {
+            cout << "Instancia com " << locais.size() << " clientes: o maximo suportado e " << BitsMascara<uint128_t>() << endl;
+        }
+        return 1;
+    }
+    // basta um processo ter sido interrompido para a busca ficar incompleta
+    MPI_Allreduce(MPI_IN_PLACE, &resultado, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (resultado != 0) {
+        if (rank == 0 && resultado == 2) {
+            cout << "Busca interrompida; continue com --checkpoint " << opcoes.checkpoint << " --resume" << endl;
+        }
+        return resultado;
+    }
+    if (!opcoes.checkpoint.empty() && rank == 0) {
+        RemoverCheckpoint(opcoes.checkpoint, ".r");
+    }
+
+    INSTR_FASE(faseReducao, REDUCAO);
+    programa.juntar(rank, size, melhorCusto, melhorCaminho);
+    INSTR_FASE_FIM(faseReducao);
+    // todos precisam saber se há solução para sair do mesmo jeito
+    MPI_Bcast(&melhorCusto, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (melhorCusto == INT_MAX) {
+        if (rank == 0) {
+            cout << "Nenhuma solucao respeita a capacidade e a frota informadas" << endl;
+        }
+        return 1;
+    }
+
+    if (rank == 0) {
+        vector<vector<int>> solucao;
+        for (int indice : melhorCaminho) {
+            solucao.push_back(rotas[indice]);
+        }
+        ImprimirRotas(solucao, matriz, deposito);
+        cout << programa.rotuloCusto << melhorCusto << endl;
+        if (relaxacao.ativo) {
+            cout << "Gap do LP: " << GapPercentual(melhorCusto, relaxacao.limite) << "%" << endl;
+        }
+        GravarCache(chave, frota, opcoes.particao, rotas, solucao, melhorCusto);
+        if (!opcoes.salvarEstado.empty()) {
+            SalvarExecucao(opcoes, numNos, demanda, arestas, solucao, estado);
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end - start;
+        std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
+        if (programa.gravarTempo) {
+            std::ofstream outputFile("tempo_execucao_" + (opcoes.arquivo.empty() ? opcoes.estado : opcoes.arquivo) + ".txt");
+            if (outputFile.is_open()) {
+                outputFile << "Tempo de execução: " << std::fixed << setprecision(3) << duration.count() << " segundos" << std::endl;
+                outputFile.close();
+            } else {
+                std::cout << "Erro ao abrir o arquivo de saída" << std::endl;
+            }
+        }
+    }
+
+    INSTR_FINALIZAR_MPI(rank, size);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef CACHE_INSTANCIAS_H
+#define CACHE_INSTANCIAS_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "candidatos.h"
+#include "opcoes.h"
+
+using namespace std;
+
+// Cache em disco de instâncias já resolvidas (--cache D), consultado antes de gerar as rotas.
+//
+// A chave é o conteúdo da instância, não o nome do arquivo: demandas, capacidade e matriz de custos numa forma
+// canônica em que a numeração dos clientes não importa. Para isso os clientes são ordenados por uma "cor"
+// que só depende dos dados: começa com a demanda e os custos de ida e volta ao depósito e é refinada, como
+// no teste de Weisfeiler-Lehman, misturando a cor de cada cliente com os custos e as cores dos seus vizinhos
+// até o número de cores parar de crescer. O depósito vira sempre o nó 0. Clientes que continuam com a mesma
+// cor (instâncias simétricas) ficam na ordem original, o que no máximo faz uma instância renumerada não
+// ser reconhecida.
+// A renumeração só é normalizada quando não muda a resposta. GerarRotasCandidatas só aceita uma rota se cada
+// cliente tem aresta para o seguinte em ordem crescente, e rotas com mais de MAX_CLIENTES_REORDENAR clientes
+// ficam nessa ordem, então com arestas faltando entre clientes ou rotas tão longas a solução depende da
+// numeração; nesses casos os clientes mantêm a ordem relativa original (só o depósito vai para o nó 0).
+//
+// Arquivos em D, todos com o hash (FNV-1a) da forma canônica no nome:
+//   <hash>.inst      a forma canônica inteira, conferida a cada consulta (colisão de hash vira falta)
+//   <hash>.rotas<L>  rotas candidatas já reduzidas e na melhor ordem (L = 1 com frota limitada, 0 sem)
+//   <hash>.cobertura<K>  custo e rotas da solução ótima com frota K (0 = ilimitada); .particao<K> com --particao
+// As rotas são gravadas com os nós canônicos e traduzidas para a numeração da instância ao serem lidas.
+// A gravação é atômica (arquivo temporário + rename), então vários processos podem usar o mesmo diretório.
+
+const char MAGIA_CACHE[8] = {'V', 'R', 'P', 'I', 'N', 'S', 'T', '1'};
+
+struct ChaveInstancia {
+    string diretorio;        // vazio = cache desligado
+    vector<int> no;          // no[i] = nó da instância que ocupa a posição canônica i (no[0] = depósito)
+    vector<int> posicao;     // inverso de "no"
+    vector<int64_t> dados;   // forma canônica: número de nós, capacidade, se foi renumerada, demandas e matriz
+    uint64_t hash = 0;
+
+    string arquivo(const string& sufixo) const {
+        char nome[17];
+        snprintf(nome, sizeof(nome), "%016llx", (unsigned long long) hash);
+        return diretorio + "/" + nome + sufixo;
+    }
+};
+
+inline uint64_t MisturarCor(uint64_t h, uint64_t x) {
+    // passo do splitmix64 sobre a combinação, para espalhar bem cores parecidas
+    uint64_t z = h ^ (x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Verdadeiro se a solução não depende da numeração dos clientes: todos têm aresta entre si e nenhuma rota
+// cabe mais que MAX_CLIENTES_REORDENAR clientes (a soma das menores demandas já estoura a capacidade)
+inline bool PodeRenumerar(const vector<int>& clientes, map<int,int>& demanda, int capacidade, const MatrizCustos& m) {
+    for (int a : clientes) {
+        for (int b : clientes) {
+            if (a != b && m(a, b) >= CUSTO_INFINITO) {
+                return false;
+            }
+        }
+    }
+    vector<int> demandas;
+    for (int c : clientes) {
+        demandas.push_back(demanda[c]);
+    }
+    if ((int) demandas.size() <= MAX_CLIENTES_REORDENAR) {
+        return true;
+    }
+    sort(demandas.begin(), demandas.end());
+    long long menores = 0;
+    for (int i = 0; i <= MAX_CLIENTES_REORDENAR; i++) {
+        menores += demandas[i];
+    }
+    return menores > capacidade;
+}
+
+inline ChaveInstancia CalcularChave(const string& diretorio, int numNos, map<int,int>& demanda, int capacidade, int deposito,
+                                    const MatrizCustos& m) {
+    ChaveInstancia chave;
+    chave.diretorio = diretorio;
+    if (diretorio.empty()) {
+        return chave;
+    }
+    vector<int> clientes = ClientesSemDeposito(numNos, deposito);
+    bool renumerar = PodeRenumerar(clientes, demanda, capacidade, m);
+    map<int, uint64_t> cor;
+    for (int c : clientes) {
+        cor[c] = MisturarCor(MisturarCor(demanda[c], (uint64_t) m(deposito, c)), (uint64_t) m(c, deposito));
+    }
+    size_t cores = 0;
+    for (size_t iteracao = 0; renumerar && iteracao < clientes.size(); iteracao++) {
+        map<int, uint64_t> nova;
+        vector<uint64_t> saida, entrada;
+        for (int c : clientes) {
+            saida.clear();
+            entrada.clear();
+            for (int v : clientes) {
+                if (v != c) {
+                    saida.push_back(MisturarCor((uint64_t) m(c, v), cor[v]));
+                    entrada.push_back(MisturarCor((uint64_t) m(v, c), cor[v]));
+                }
+            }
+            sort(saida.begin(), saida.end());
+            sort(entrada.begin(), entrada.end());
+            uint64_t h = cor[c];
+            for (uint64_t x : saida) {
+                h = MisturarCor(h, x);
+            }
+            h = MisturarCor(h, 0);
+            for (uint64_t x : entrada) {
+                h = MisturarCor(h, x);
+            }
+            nova[c] = h;
+        }
+        vector<uint64_t> distintas;
+        for (const auto& p : nova) {
+            distintas.push_back(p.second);
+        }
+        sort(distintas.begin(), distintas.end());
+        size_t novasCores = unique(distintas.begin(), distintas.end()) - distintas.begin();
+        cor = nova;
+        if (novasCores <= cores) {
+            break;
+        }
+        cores = novasCores;
+    }
+    if (renumerar) {
+        stable_sort(clientes.begin(), clientes.end(), [&](int a, int b) { return cor[a] < cor[b]; });
+    }
+
+    chave.no.push_back(deposito);
+    chave.no.insert(chave.no.end(), clientes.begin(), clientes.end());
+    chave.posicao.assign(numNos, 0);
+    for (int i = 0; i < numNos; i++) {
+        chave.posicao[chave.no[i]] = i;
+    }
+    chave.dados.push_back(numNos);
+    chave.dados.push_back(capacidade);
+    chave.dados.push_back(renumerar);
+    for (int i = 1; i < numNos; i++) {
+        chave.dados.push_back(demanda[chave.no[i]]);
+    }
+    for (int i = 0; i < numNos; i++) {
+        for (int j = 0; j < numNos; j++) {
+            chave.dados.push_back(m(chave.no[i], chave.no[j]));
+        }
+    }
+    chave.hash = 0xcbf29ce484222325ULL;
+    const unsigned char* p = (const unsigned char*) chave.dados.data();
+    for (size_t i = 0; i < chave.dados.size() * sizeof(int64_t); i++) {
+        chave.hash = (chave.hash ^ p[i]) * 0x100000001b3ULL;
+    }
+    return chave;
+}
+
+// Confere se <hash>.inst guarda exatamente esta instância
+inline bool MesmaInstancia(const ChaveInstancia& chave) {
+    FILE* f = fopen(chave.arquivo(".inst").c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    char magia[8];
+    uint64_t tamanho = 0;
+    bool ok = fread(magia, sizeof(magia), 1, f) == 1 && memcmp(magia, MAGIA_CACHE, sizeof(magia)) == 0
+              && fread(&tamanho, sizeof(tamanho), 1, f) == 1 && tamanho == chave.dados.size();
+    vector<int64_t> dados(ok ? tamanho : 0);
+    ok = ok && fread(dados.data(), sizeof(int64_t), dados.size(), f) == dados.size() && dados == chave.dados;
+    fclose(f);
+    return ok;
+}
+
+// Lê "quantidade" rotas no formato "k c1 ... ck" e traduz os nós canônicos para os da instância
+inline bool LerRotasCanonicas(istream& arquivo, const ChaveInstancia& chave, vector<vector<int>>& rotas) {
+    size_t quantidade;
+    if (!(arquivo >> quantidade)) {
+        return false;
+    }
+    rotas.assign(quantidade, {});
+    for (auto& rota : rotas) {
+        size_t k;
+        arquivo >> k;
+        rota.resize(k);
+        for (int& cliente : rota) {
+            int canonico;
+            arquivo >> canonico;
+            if (canonico <= 0 || canonico >= (int) chave.no.size()) {
+                return false;
+            }
+            cliente = chave.no[canonico];
+        }
+    }
+    return !arquivo.fail();
+}
+
+// A cobertura pode sair mais barata que a partição, então as duas soluções ficam em arquivos separados
+inline string SufixoSolucao(int frota, bool particao) {
+    return (particao ? ".particao" : ".cobertura") + to_string(frota);
+}
+
+// Solução ótima já guardada para esta instância com esta frota
+inline bool LerSolucaoCache(const ChaveInstancia& chave, int frota, bool particao, const MatrizCustos& m, int deposito,
+                            vector<vector<int>>& solucao, int& custo) {
+    if (chave.diretorio.empty() || !MesmaInstancia(chave)) {
+        return false;
+    }
+    ifstream arquivo(chave.arquivo(SufixoSolucao(frota, particao)));
+    if (!(arquivo >> custo) || !LerRotasCanonicas(arquivo, chave, solucao)) {
+        return false;
+    }
+    // o custo guardado tem que bater com o custo das rotas nesta instância
+    long long total = 0;
+    for (const auto& rota : solucao) {
+        total += m.custoRota(rota, deposito);
+    }
+    return total == custo;
+}
+
+// Cada rota na melhor ordem vira a rota como GerarRotasCandidatas a geraria, com a ordem guardada em "ordens"
+inline void RotasDasOrdens(const vector<vector<int>>& tabela, vector<vector<int>>& rotas, CacheOrdens& ordens,
+                           const MatrizCustos& m, int deposito) {
+    rotas.clear();
+    for (const auto& ordem : tabela) {
+        vector<int> rota = ordem;
+        sort(rota.begin(), rota.end());
+        ordens[rota] = {m.custoRota(ordem, deposito), ordem};
+        rotas.push_back(std::move(rota));
+    }
+}
+
+// Tabela de rotas candidatas já reduzidas. As rotas voltam como GerarRotasCandidatas as geraria (clientes em
+// ordem crescente) e a melhor ordem de cada uma vai para "ordens", então ReduzirCandidatos só refaz a
+// ordenação da tabela, sem Held-Karp.
+inline bool LerRotasCache(const ChaveInstancia& chave, bool frotaLimitada, vector<vector<int>>& rotas, CacheOrdens& ordens,
+                          const MatrizCustos& m, int deposito) {
+    if (chave.diretorio.empty() || !MesmaInstancia(chave)) {
+        return false;
+    }
+    ifstream arquivo(chave.arquivo(".rotas" + to_string((int) frotaLimitada)));
+    vector<vector<int>> tabela;
+    if (!LerRotasCanonicas(arquivo, chave, tabela)) {
+        return false;
+    }
+    RotasDasOrdens(tabela, rotas, ordens, m, deposito);
+    return true;
+}
+
+inline bool GravarAtomico(const string& caminho, const string& conteudo) {
+    string temporario = caminho + ".tmp";
+    FILE* f = fopen(temporario.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = fwrite(conteudo.data(), 1, conteudo.size(), f) == conteudo.size();
+    ok = fclose(f) == 0 && ok;
+    return ok && rename(temporario.c_str(), caminho.c_str()) == 0;
+}
+
+inline string RotasCanonicas(const ChaveInstancia& chave, const vector<vector<int>>& rotas) {
+    string texto = to_string(rotas.size()) + "\n";
+    for (const auto& rota : rotas) {
+        texto += to_string(rota.size());
+        for (int cliente : rota) {
+            texto += " " + to_string(chave.posicao[cliente]);
+        }
+        texto += "\n";
+    }
+    return texto;
+}
+
+// Guarda a tabela de rotas reduzidas e a solução ótima da execução. Se já existe outra instância com o
+// mesmo hash, nada é gravado. O diretório é criado na primeira gravação.
+inline void GravarCache(const ChaveInstancia& chave, int frota, bool particao, const vector<vector<int>>& rotasReduzidas,
+                        const vector<vector<int>>& solucao, int custo) {
+    if (chave.diretorio.empty()) {
+        return;
+    }
+    error_code erro;
+    filesystem::create_directories(chave.diretorio, erro);
+    if (!MesmaInstancia(chave)) {
+        FILE* f = fopen(chave.arquivo(".inst").c_str(), "rb");
+        if (f) {
+            fclose(f);
+            cerr << "Cache: outra instancia com o mesmo hash em " << chave.arquivo(".inst") << endl;
+            return;
+        }
+        string conteudo(MAGIA_CACHE, sizeof(MAGIA_CACHE));
+        uint64_t tamanho = chave.dados.size();
+        conteudo.append((const char*) &tamanho, sizeof(tamanho));
+        conteudo.append((const char*) chave.dados.data(), chave.dados.size() * sizeof(int64_t));
+        if (!GravarAtomico(chave.arquivo(".inst"), conteudo)) {
+            cerr << "Cache: erro ao gravar em " << chave.diretorio << endl;
+            return;
+        }
+    }
+    // com a tabela em disco o solver não tem as rotas reduzidas na memória e só grava a solução
+    if (!rotasReduzidas.empty()) {
+        GravarAtomico(chave.arquivo(".rotas" + to_string((int) (frota > 0))), RotasCanonicas(chave, rotasReduzidas));
+    }
+    GravarAtomico(chave.arquivo(SufixoSolucao(frota, particao)), to_string(custo) + "\n" + RotasCanonicas(chave, solucao));
+}
+
+#ifdef MPI_VERSION
+// Nos programas MPI só o rank 0 consulta o cache e a resposta vai dele para os outros. Se cada processo lesse
+// o diretório por conta própria, outro job trocando um arquivo no meio da leitura faria os ranks discordarem:
+// um sai com a solução enquanto os outros entram na busca coletiva e travam, ou cada um monta a tabela numa
+// ordem e a divisão das tarefas deixa de cobrir todas as combinações.
+
+// Manda as rotas do rank 0 para todos (achatadas em "k c1 ... ck", em blocos para não estourar o int do MPI)
+inline void DifundirRotas(vector<vector<int>>& rotas, int rank) {
+    vector<int> plano;
+    if (rank == 0) {
+        for (const auto& rota : rotas) {
+            plano.push_back(rota.size());
+            plano.insert(plano.end(), rota.begin(), rota.end());
+        }
+    }
+    long long tamanho = plano.size();
+    MPI_Bcast(&tamanho, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+    plano.resize(tamanho);
+    const long long bloco = 1 << 28;
+    for (long long inicio = 0; inicio < tamanho; inicio += bloco) {
+        MPI_Bcast(plano.data() + inicio, (int) min(bloco, tamanho - inicio), MPI_INT, 0, MPI_COMM_WORLD);
+    }
+    if (rank != 0) {
+        rotas.clear();
+        for (size_t i = 0; i < plano.size(); i += plano[i] + 1) {
+            rotas.emplace_back(plano.begin() + i + 1, plano.begin() + i + 1 + plano[i]);
+        }
+    }
+}
+
+inline bool LerSolucaoCacheMPI(const ChaveInstancia& chave, int frota, bool particao, const MatrizCustos& m, int deposito,
+                               vector<vector<int>>& solucao, int& custo, int rank) {
+    int achou = rank == 0 && LerSolucaoCache(chave, frota, particao, m, deposito, solucao, custo);
+    MPI_Bcast(&achou, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (achou) {
+        MPI_Bcast(&custo, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        DifundirRotas(solucao, rank);
+    }
+    return achou;
+}
+
+// A tabela vai na melhor ordem de cada rota, e cada rank refaz "rotas" e "ordens" como LerRotasCache
+inline bool LerRotasCacheMPI(const ChaveInstancia& chave, bool frotaLimitada, vector<vector<int>>& rotas, CacheOrdens& ordens,
+                             const MatrizCustos& m, int deposito, int rank) {
+    int achou = rank == 0 && LerRotasCache(chave, frotaLimitada, rotas, ordens, m, deposito);
+    MPI_Bcast(&achou, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!achou) {
+        return false;
+    }
+    vector<vector<int>> tabela;
+    if (rank == 0) {
+        for (const auto& rota : rotas) {
+            tabela.push_back(ordens[rota].ordem);
+        }
+    }
+    DifundirRotas(tabela, rank);
+    if (rank != 0) {
+        RotasDasOrdens(tabela, rotas, ordens, m, deposito);
+    }
+    return true;
+}
+#endif
+
+// Impressão da solução usada quando ela vem do cache, igual à dos solvers depois da busca
+inline void ImprimirRotas(const vector<vector<int>>& rotas, const MatrizCustos& m, int deposito) {
+    cout << "Melhor combinação de rotas:" << endl;
+    for (const auto& rota : rotas) {
+        cout << "{ ";
+        for (int cidade : rota) {
+            cout << cidade << " ";
+        }
+        cout << "} com custo: " << m.custoRota(rota, deposito) << endl;
+    }
+}
+
+#endif
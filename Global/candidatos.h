@@ -0,0 +1,300 @@
+#ifndef CANDIDATOS_H
+#define CANDIDATOS_H
+
+#include <vector>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include "mascara.h"
+
+using namespace std;
+
+// Geração e pré-processamento das rotas candidatas antes da busca:
+//  1. as rotas são geradas por uma busca em profundidade sobre os clientes que para assim que a capacidade
+//     estoura, em vez de percorrer todos os 2^n subconjuntos (o que também deixava 1 << n estourar com n > 31);
+//  2. cada rota passa a visitar os seus clientes na melhor ordem possível (Held-Karp sobre os clientes da rota),
+//     já que a mesma rota em outra ordem pode custar bem menos que a ordem crescente gerada (fica a ordem
+//     gerada quando ela é mais barata, o que só acontece se ela passa por uma aresta inexistente);
+//  3. rotas dominadas são removidas: se os clientes de uma rota podem ser atendidos por duas ou mais rotas
+//     candidatas disjuntas com custo total menor ou igual, nenhuma solução ótima precisa dela (só quando a
+//     frota é ilimitada, porque a troca aumenta o número de veículos);
+//  4. as rotas são ordenadas pelo menor cliente e, dentro disso, pelo custo, que é a ordem em que a busca
+//     por partições (buscaIterativa.h) as consome.
+
+const int CUSTO_INFINITO = INT_MAX / 4;
+
+// Matriz densa de custos (nós 0..N-1), montada a partir das arestas lidas; aresta inexistente = CUSTO_INFINITO
+struct MatrizCustos {
+    int n = 0;
+    vector<int> custo;
+
+    MatrizCustos(int numNos, const vector<tuple<int, int, int>>& arestas) : n(numNos), custo((size_t) numNos * numNos, CUSTO_INFINITO) {
+        for (const auto& aresta : arestas) {
+            int origem = get<0>(aresta), destino = get<1>(aresta);
+            // assim como no cálculo de custo original (lista de adjacência), vale a primeira aresta encontrada entre dois nós
+            if (origem < n && destino < n && custo[(size_t) origem * n + destino] == CUSTO_INFINITO) {
+                custo[(size_t) origem * n + destino] = get<2>(aresta);
+            }
+        }
+    }
+
+    int operator()(int origem, int destino) const {
+        return custo[(size_t) origem * n + destino];
+    }
+
+    // Custo da rota saindo e voltando ao depósito. Como no cálculo de custo original, aresta que não existe soma 0.
+    int custoRota(const vector<int>& rota, int deposito) const {
+        int total = 0;
+        int anterior = deposito;
+        for (size_t i = 0; i <= rota.size(); i++) {
+            int proximo = i < rota.size() ? rota[i] : deposito;
+            int aresta = (*this)(anterior, proximo);
+            total += aresta < CUSTO_INFINITO ? aresta : 0;
+            anterior = proximo;
+        }
+        return total;
+    }
+};
+
+// Todas as rotas (clientes em ordem crescente de posição em "locais") que respeitam a capacidade e em que
+// cada cliente tem aresta para o seguinte: o mesmo conjunto que GerarTodasAsCombinacoes gerava testando os
+// 2^n subconjuntos, mas descartando um prefixo inteiro assim que ele fica inválido. Cada rota é passada para
+// visitar(rota, carga) assim que é formada; como a busca estende sempre o prefixo atual, todas as rotas que
+// começam pelo cliente locais[j] saem antes das que começam por locais[j + 1].
+template <typename Visitante>
+void PercorrerRotasCandidatas(const vector<int>& locais, map<int,int>& demanda, int capacidade, const MatrizCustos& m, Visitante&& visitar) {
+    int n = locais.size();
+    vector<int> rota;
+    // pilha explícita de (posição do próximo cliente a tentar, carga da rota atual)
+    vector<pair<int, int>> pilha;
+    pilha.push_back({0, 0});
+    while (!pilha.empty()) {
+        auto& topo = pilha.back();
+        if (topo.first >= n) {
+            pilha.pop_back();
+            if (!rota.empty()) {
+                rota.pop_back();
+            }
+            continue;
+        }
+        int j = topo.first++;
+        int carga = topo.second + demanda[locais[j]];
+        if (carga > capacidade) {
+            continue;
+        }
+        if (!rota.empty() && m(rota.back(), locais[j]) >= CUSTO_INFINITO) {
+            continue;
+        }
+        rota.push_back(locais[j]);
+        visitar((const vector<int>&) rota, carga);
+        pilha.push_back({j + 1, carga});
+    }
+}
+
+inline vector<vector<int>> GerarRotasCandidatas(const vector<int>& locais, map<int,int>& demanda, int capacidade, const MatrizCustos& m) {
+    vector<vector<int>> rotas;
+    PercorrerRotasCandidatas(locais, demanda, capacidade, m, [&rotas](const vector<int>& rota, int) {
+        rotas.push_back(rota);
+    });
+    return rotas;
+}
+
+// Rotas com mais clientes que isso ficam na ordem em que vieram (o Held-Karp é O(2^k k^2))
+const int MAX_CLIENTES_REORDENAR = 16;
+
+// Melhor ordem de visita dos clientes da rota, saindo e voltando ao depósito. Devolve CUSTO_INFINITO se não
+// existir ordem com todas as arestas.
+inline int MelhorOrdem(const MatrizCustos& m, int deposito, const vector<int>& clientes, vector<int>& ordem) {
+    int k = clientes.size();
+    int total = 1 << k;
+    vector<int> dp((size_t) total * k, CUSTO_INFINITO);
+    vector<int8_t> anterior((size_t) total * k, -1);
+    for (int j = 0; j < k; j++) {
+        dp[(size_t) (1 << j) * k + j] = m(deposito, clientes[j]);
+    }
+    for (int s = 1; s < total; s++) {
+        for (int j = 0; j < k; j++) {
+            int atual = dp[(size_t) s * k + j];
+            if (!(s & (1 << j)) || atual >= CUSTO_INFINITO) {
+                continue;
+            }
+            for (int l = 0; l < k; l++) {
+                if (s & (1 << l)) {
+                    continue;
+                }
+                int aresta = m(clientes[j], clientes[l]);
+                if (aresta >= CUSTO_INFINITO) {
+                    continue;
+                }
+                size_t proximo = (size_t) (s | (1 << l)) * k + l;
+                if (atual + aresta < dp[proximo]) {
+                    dp[proximo] = atual + aresta;
+                    anterior[proximo] = j;
+                }
+            }
+        }
+    }
+    int melhor = CUSTO_INFINITO, ultimo = -1;
+    for (int j = 0; j < k; j++) {
+        int volta = m(clientes[j], deposito);
+        int custo = dp[(size_t) (total - 1) * k + j];
+        if (custo < CUSTO_INFINITO && volta < CUSTO_INFINITO && custo + volta < melhor) {
+            melhor = custo + volta;
+            ultimo = j;
+        }
+    }
+    if (ultimo < 0) {
+        return CUSTO_INFINITO;
+    }
+    ordem.assign(k, 0);
+    for (int s = total - 1, j = ultimo, pos = k - 1; j >= 0; pos--) {
+        ordem[pos] = clientes[j];
+        int a = anterior[(size_t) s * k + j];
+        s ^= 1 << j;
+        j = a;
+    }
+    return melhor;
+}
+
+// Custo da rota na melhor ordem, que vai para "ordem". O Held-Karp só usa arestas que existem, mas custoRota
+// (como o cálculo original) conta aresta inexistente como 0, então a ordem em que a rota foi gerada pode
+// sair mais barata; nesse caso, sem ordem com todas as arestas ou com a rota grande demais para o Held-Karp,
+// a rota fica como foi gerada.
+inline int OrdenarRota(const MatrizCustos& m, int deposito, const vector<int>& rota, vector<int>& ordem) {
+    int gerada = m.custoRota(rota, deposito);
+    if ((int) rota.size() <= MAX_CLIENTES_REORDENAR) {
+        int custo = MelhorOrdem(m, deposito, rota, ordem);
+        if (custo <= gerada) {
+            return custo;
+        }
+    }
+    ordem = rota;
+    return gerada;
+}
+
+// Menor custo para atender exatamente os clientes de "s" com rotas candidatas disjuntas (CUSTO_INFINITO se não dá)
+template <typename Mascara>
+int MelhorParticao(Mascara s, const unordered_map<Mascara, int, HashMascara>& custoDe, unordered_map<Mascara, int, HashMascara>& memo) {
+    if (s == 0) {
+        return 0;
+    }
+    auto it = memo.find(s);
+    if (it != memo.end()) {
+        return it->second;
+    }
+    // a rota que atende o menor cliente de s precisa estar na partição: basta enumerar os subconjuntos que o contêm
+    Mascara menor = s & (~s + 1);
+    Mascara resto = s ^ menor;
+    int melhor = CUSTO_INFINITO;
+    for (Mascara sub = resto;; sub = (sub - 1) & resto) {
+        Mascara a = sub | menor;
+        auto rota = custoDe.find(a);
+        if (rota != custoDe.end()) {
+            int outros = MelhorParticao(Mascara(s ^ a), custoDe, memo);
+            if (outros < CUSTO_INFINITO) {
+                melhor = min(melhor, rota->second + outros);
+            }
+        }
+        if (sub == 0) {
+            break;
+        }
+    }
+    memo[s] = melhor;
+    return melhor;
+}
+
+// Melhor ordem já calculada de uma rota. A chave do cache é a rota como foi gerada (clientes em ordem
+// crescente), e o valor só depende das arestas entre os clientes da rota e o depósito, então o cache
+// continua válido entre execuções enquanto essas arestas não mudam (ver incremental.h).
+struct OrdemCacheada {
+    int custo;
+    vector<int> ordem;
+};
+typedef map<vector<int>, OrdemCacheada> CacheOrdens;
+
+// Aplica os passos 2 a 4 descritos no topo do arquivo sobre as rotas geradas (mesma ordem de clientes de "locais").
+// Com "cache", as rotas que já estão nele não passam de novo pelo Held-Karp e as novas são acrescentadas.
+template <typename Mascara>
+void ReduzirCandidatos(vector<vector<int>>& rotas, const vector<int>& locais, const MatrizCustos& m, int deposito, bool frotaLimitada,
+                       CacheOrdens* cache = nullptr) {
+    map<int,int> bit;
+    for (int j = 0; j < (int) locais.size(); j++) {
+        bit[locais[j]] = j;
+    }
+
+    struct Candidata {
+        Mascara mascara;
+        int custo;
+        vector<int> ordem;
+    };
+    vector<Candidata> candidatas;
+    candidatas.reserve(rotas.size());
+    for (auto& rota : rotas) {
+        Candidata c = {0, CUSTO_INFINITO, rota};
+        for (int cidade : rota) {
+            c.mascara |= Mascara(1) << bit[cidade];
+        }
+        if (cache) {
+            auto it = cache->find(rota);
+            if (it != cache->end()) {
+                c.custo = it->second.custo;
+                c.ordem = it->second.ordem;
+                candidatas.push_back(c);
+                continue;
+            }
+        }
+        c.custo = OrdenarRota(m, deposito, rota, c.ordem);
+        if (cache) {
+            (*cache)[rota] = {c.custo, c.ordem};
+        }
+        candidatas.push_back(c);
+    }
+
+    vector<Candidata> mantidas;
+    if (frotaLimitada) {
+        mantidas = std::move(candidatas);
+    } else {
+        unordered_map<Mascara, int, HashMascara> custoDe;
+        for (const auto& c : candidatas) {
+            custoDe[c.mascara] = c.custo;
+        }
+        unordered_map<Mascara, int, HashMascara> memo;
+        for (auto& c : candidatas) {
+            Mascara menor = c.mascara & (~c.mascara + 1);
+            Mascara resto = c.mascara ^ menor;
+            bool dominada = false;
+            // sub percorre os subconjuntos próprios de resto; a rota inteira (sub == resto) não conta
+            for (Mascara sub = (resto - 1) & resto; resto != 0 && !dominada; sub = (sub - 1) & resto) {
+                Mascara a = sub | menor;
+                auto rota = custoDe.find(a);
+                if (rota != custoDe.end()) {
+                    int outros = MelhorParticao(Mascara(c.mascara ^ a), custoDe, memo);
+                    dominada = outros < CUSTO_INFINITO && rota->second + outros <= c.custo;
+                }
+                if (sub == 0) {
+                    break;
+                }
+            }
+            if (!dominada) {
+                mantidas.push_back(std::move(c));
+            }
+        }
+    }
+
+    sort(mantidas.begin(), mantidas.end(), [](const Candidata& a, const Candidata& b) {
+        int menorA = MenorBit(a.mascara), menorB = MenorBit(b.mascara);
+        if (menorA != menorB) {
+            return menorA < menorB;
+        }
+        return a.custo < b.custo;
+    });
+    rotas.clear();
+    for (auto& c : mantidas) {
+        rotas.push_back(std::move(c.ordem));
+    }
+}
+
+#endif
@@ -0,0 +1,495 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <csignal>
+#include <climits>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <iostream>
+#include "buscaIterativa.h"
+
+using namespace std;
+
+// Ponto de controle (checkpoint) da busca exaustiva, para continuar de onde parou depois de um limite de
+// tempo ou de uma preempção do SLURM.
+//
+// Cada trabalhador (thread no OpenMP, processo no MPI) grava de tempos em tempos o seu próprio arquivo
+// binário <prefixo>.t<thread> ou <prefixo>.r<rank> com: as tarefas terminadas (em intervalos de índices, já
+// que o número de tarefas cresce com o de rotas; as threads de um processo gravam o conjunto do processo, que
+// fica contíguo porque elas pegam as tarefas em ordem), a pilha de quadros e o
+// caminho da tarefa em andamento, a melhor solução que conhece e o número de nós visitados. A gravação é
+// feita num arquivo temporário renomeado em seguida, então um arquivo nunca fica pela metade. A busca só
+// consulta o relógio a cada 2^14 nós, e sem --checkpoint o gancho da busca é SemPontoControle.
+//
+// Com --resume, todos os arquivos são lidos e juntados em <prefixo>.base (as tarefas terminadas, as pilhas
+// das tarefas interrompidas e a melhor solução); os arquivos dos trabalhadores são apagados e a execução
+// continua cada tarefa interrompida a partir da sua pilha e depois as que ainda não começaram. Assim dá
+// para retomar com outro número de threads ou processos. Os arquivos só servem para a mesma instância com
+// os mesmos parâmetros: o cabeçalho guarda uma impressão digital das rotas e das tarefas e é conferido.
+// SIGTERM ou SIGUSR1 (sbatch --signal=USR1@60) fazem todos os trabalhadores gravarem e pararem logo.
+
+const char MAGIA_CHECKPOINT[8] = {'V', 'R', 'P', 'C', 'K', 'P', 'T', '2'};
+// a cada 2^14 nós o trabalhador confere se está na hora de gravar
+const uint64_t MASCARA_CHECKPOINT = (1u << 14) - 1;
+
+inline volatile sig_atomic_t pararSolicitado = 0;
+
+inline void TratarSinalParada(int) {
+    pararSolicitado = 1;
+}
+
+inline void InstalarSinalParada() {
+    signal(SIGTERM, TratarSinalParada);
+    signal(SIGUSR1, TratarSinalParada);
+}
+
+struct CabecalhoCheckpoint {
+    char magia[8];
+    uint32_t bitsMascara;
+    uint32_t minimoTarefas;  // parâmetro usado em GerarTarefas, para gerar as mesmas tarefas ao retomar
+    uint64_t numRotas;
+    uint64_t numTarefas;
+    uint64_t impressao;
+    uint64_t nos;
+    int32_t melhorCusto;
+    uint32_t tamanhoMelhor;
+    uint32_t numConcluidas;  // intervalos de tarefas concluídas
+    uint32_t numParciais;
+};
+
+// Tarefa interrompida: a pilha e o caminho até o quadro do topo
+template <typename Mascara>
+struct TarefaParcial {
+    vector<Quadro<Mascara>> pilha;
+    vector<int> caminho;
+};
+
+// Conjunto de tarefas como intervalos [início, fim) ordenados, disjuntos e não encostados
+struct IntervalosTarefas {
+    vector<pair<int, int>> intervalos;
+
+    void inserir(int inicio, int fim) {
+        // do primeiro intervalo que termina em "inicio" ou depois até o último que começa em "fim" ou antes
+        auto a = lower_bound(intervalos.begin(), intervalos.end(), inicio, [](const pair<int, int>& x, int v) {
+            return x.second < v;
+        });
+        auto b = upper_bound(a, intervalos.end(), fim, [](int v, const pair<int, int>& x) {
+            return v < x.first;
+        });
+        if (a != b) {
+            inicio = min(inicio, a->first);
+            fim = max(fim, prev(b)->second);
+            a = intervalos.erase(a, b);
+        }
+        intervalos.insert(a, {inicio, fim});
+    }
+
+    bool contem(int t) const {
+        auto it = upper_bound(intervalos.begin(), intervalos.end(), t, [](int v, const pair<int, int>& x) {
+            return v < x.first;
+        });
+        return it != intervalos.begin() && prev(it)->second > t;
+    }
+
+    long long quantidade() const {
+        long long total = 0;
+        for (const auto& x : intervalos) {
+            total += x.second - x.first;
+        }
+        return total;
+    }
+};
+
+template <typename Mascara>
+struct Retomada {
+    CabecalhoCheckpoint cabecalho;
+    IntervalosTarefas concluida;
+    map<int, TarefaParcial<Mascara>> parciais;    // por tarefa
+    int melhorCusto = INT_MAX;
+    vector<int> melhorCaminho;
+    uint64_t nos = 0;
+};
+
+// FNV-1a sobre as rotas compactas, as rotas que podem sobrepor e as tarefas: muda se a instância, os
+// parâmetros, a redução ou a escolha entre cobertura e partição mudarem
+template <typename Mascara>
+uint64_t ImpressaoBusca(TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice, const ListaTarefas<Mascara>& tarefas) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto misturar = [&h](const void* dados, size_t tamanho) {
+        const unsigned char* p = (const unsigned char*) dados;
+        for (size_t i = 0; i < tamanho; i++) {
+            h = (h ^ p[i]) * 0x100000001b3ULL;
+        }
+    };
+    for (const auto& r : rotas) {
+        misturar(&r.mascara, sizeof(r.mascara));
+        misturar(&r.custo, sizeof(r.custo));
+    }
+    misturar(indice.sobrepoe.data(), indice.sobrepoe.size());
+    for (int i = 0; i < tarefas.size(); i++) {
+        Tarefa<Mascara> t = tarefas.tarefa(rotas, i);
+        misturar(t.prefixo, sizeof(int) * t.tamanho);
+    }
+    return h;
+}
+
+template <typename Mascara>
+CabecalhoCheckpoint CabecalhoEsperado(TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice, const ListaTarefas<Mascara>& tarefas,
+                                      int minimoTarefas) {
+    CabecalhoCheckpoint c;
+    memset(&c, 0, sizeof(c));
+    memcpy(c.magia, MAGIA_CHECKPOINT, sizeof(c.magia));
+    c.bitsMascara = BitsMascara<Mascara>();
+    c.minimoTarefas = minimoTarefas;
+    c.numRotas = rotas.size();
+    c.numTarefas = tarefas.size();
+    c.impressao = ImpressaoBusca(rotas, indice, tarefas);
+    c.melhorCusto = INT_MAX;
+    return c;
+}
+
+inline bool MesmaBusca(const CabecalhoCheckpoint& a, const CabecalhoCheckpoint& b) {
+    return memcmp(a.magia, b.magia, sizeof(a.magia)) == 0 && a.bitsMascara == b.bitsMascara && a.minimoTarefas == b.minimoTarefas
+           && a.numRotas == b.numRotas && a.numTarefas == b.numTarefas && a.impressao == b.impressao;
+}
+
+inline bool ExisteArquivo(const string& caminho) {
+    FILE* f = fopen(caminho.c_str(), "rb");
+    if (f) {
+        fclose(f);
+    }
+    return f != nullptr;
+}
+
+// Parâmetro "minimo" de GerarTarefas usado pela execução que gravou o checkpoint (ou "padrao" se não há nenhum).
+// Precisa ser lido antes de gerar as tarefas, já que ele decide se elas são divididas.
+inline int MinimoTarefasSalvo(const string& prefixo, const string& sufixo, int padrao) {
+    for (const string& caminho : {prefixo + ".base", prefixo + sufixo + "0"}) {
+        FILE* f = fopen(caminho.c_str(), "rb");
+        if (!f) {
+            continue;
+        }
+        CabecalhoCheckpoint c;
+        bool ok = fread(&c, sizeof(c), 1, f) == 1 && memcmp(c.magia, MAGIA_CHECKPOINT, sizeof(c.magia)) == 0;
+        fclose(f);
+        if (ok) {
+            return c.minimoTarefas;
+        }
+    }
+    return padrao;
+}
+
+// Grava de forma atômica (arquivo temporário + rename)
+template <typename Mascara>
+bool GravarCheckpoint(const string& caminho, CabecalhoCheckpoint cabecalho, int melhorCusto, const vector<int>& melhorCaminho,
+                      const IntervalosTarefas& concluidas, const vector<pair<int, const TarefaParcial<Mascara>*>>& parciais, uint64_t nos) {
+    string temporario = caminho + ".tmp";
+    FILE* f = fopen(temporario.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    cabecalho.nos = nos;
+    cabecalho.melhorCusto = melhorCusto;
+    cabecalho.tamanhoMelhor = melhorCaminho.size();
+    cabecalho.numConcluidas = concluidas.intervalos.size();
+    cabecalho.numParciais = parciais.size();
+    bool ok = fwrite(&cabecalho, sizeof(cabecalho), 1, f) == 1;
+    ok = ok && fwrite(melhorCaminho.data(), sizeof(int), melhorCaminho.size(), f) == melhorCaminho.size();
+    for (const auto& x : concluidas.intervalos) {
+        int32_t intervalo[2] = {x.first, x.second};
+        ok = ok && fwrite(intervalo, sizeof(intervalo), 1, f) == 1;
+    }
+    for (const auto& p : parciais) {
+        int32_t tarefa = p.first;
+        uint32_t tamanhos[2] = {(uint32_t) p.second->pilha.size(), (uint32_t) p.second->caminho.size()};
+        ok = ok && fwrite(&tarefa, sizeof(tarefa), 1, f) == 1 && fwrite(tamanhos, sizeof(tamanhos), 1, f) == 1;
+        ok = ok && fwrite(p.second->pilha.data(), sizeof(Quadro<Mascara>), tamanhos[0], f) == tamanhos[0];
+        ok = ok && fwrite(p.second->caminho.data(), sizeof(int), tamanhos[1], f) == tamanhos[1];
+    }
+    ok = fclose(f) == 0 && ok;
+    return ok && rename(temporario.c_str(), caminho.c_str()) == 0;
+}
+
+// Junta um arquivo em "r". Parciais lidas depois sobrescrevem as anteriores da mesma tarefa (os arquivos dos
+// trabalhadores são mais novos que a base).
+template <typename Mascara>
+bool LerCheckpoint(const string& caminho, const CabecalhoCheckpoint& esperado, Retomada<Mascara>& r) {
+    FILE* f = fopen(caminho.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    CabecalhoCheckpoint c;
+    bool ok = fread(&c, sizeof(c), 1, f) == 1 && MesmaBusca(c, esperado);
+    if (!ok) {
+        cerr << "Checkpoint de outra instancia ou de outros parametros: " << caminho << endl;
+    }
+    vector<int> caminhoMelhor(ok ? c.tamanhoMelhor : 0);
+    vector<int32_t> concluidas(ok ? 2 * (size_t) c.numConcluidas : 0);
+    ok = ok && fread(caminhoMelhor.data(), sizeof(int), caminhoMelhor.size(), f) == caminhoMelhor.size();
+    ok = ok && fread(concluidas.data(), sizeof(int32_t), concluidas.size(), f) == concluidas.size();
+    for (uint32_t i = 0; ok && i < c.numParciais; i++) {
+        int32_t tarefa;
+        uint32_t tamanhos[2];
+        ok = fread(&tarefa, sizeof(tarefa), 1, f) == 1 && fread(tamanhos, sizeof(tamanhos), 1, f) == 1
+             && tarefa >= 0 && (uint64_t) tarefa < c.numTarefas && tamanhos[0] <= (uint32_t) BitsMascara<Mascara>() + 1
+             && tamanhos[1] <= (uint32_t) BitsMascara<Mascara>() + 1;
+        if (ok) {
+            TarefaParcial<Mascara>& p = r.parciais[tarefa];
+            p.pilha.resize(tamanhos[0]);
+            p.caminho.resize(tamanhos[1]);
+            ok = fread(p.pilha.data(), sizeof(Quadro<Mascara>), tamanhos[0], f) == tamanhos[0]
+                 && fread(p.caminho.data(), sizeof(int), tamanhos[1], f) == tamanhos[1];
+        }
+    }
+    fclose(f);
+    if (!ok) {
+        return false;
+    }
+    for (size_t i = 0; i < concluidas.size(); i += 2) {
+        int inicio = max(concluidas[i], 0), fim = (int) min<int64_t>(concluidas[i + 1], c.numTarefas);
+        if (inicio < fim) {
+            r.concluida.inserir(inicio, fim);
+        }
+    }
+    if (!caminhoMelhor.empty() && c.melhorCusto < r.melhorCusto) {
+        r.melhorCusto = c.melhorCusto;
+        r.melhorCaminho = caminhoMelhor;
+    }
+    r.nos += c.nos;
+    return true;
+}
+
+// Lê <prefixo>.base e os arquivos <prefixo><sufixo>0, 1, ... da última execução. Devolve também os caminhos
+// lidos, para a consolidação apagar depois.
+template <typename Mascara>
+bool CarregarRetomada(const string& prefixo, const string& sufixo, const CabecalhoCheckpoint& esperado, Retomada<Mascara>& r,
+                      vector<string>& lidos) {
+    r.cabecalho = esperado;
+    r.concluida = IntervalosTarefas();
+    string base = prefixo + ".base";
+    if (ExisteArquivo(base)) {
+        if (!LerCheckpoint(base, esperado, r)) {
+            return false;
+        }
+    }
+    for (int i = 0;; i++) {
+        string caminho = prefixo + sufixo + to_string(i);
+        if (!ExisteArquivo(caminho)) {
+            break;
+        }
+        if (!LerCheckpoint(caminho, esperado, r)) {
+            return false;
+        }
+        lidos.push_back(caminho);
+    }
+    for (auto it = r.parciais.begin(); it != r.parciais.end();) {
+        it = r.concluida.contem(it->first) ? r.parciais.erase(it) : next(it);
+    }
+    return true;
+}
+
+// Grava tudo o que foi juntado em <prefixo>.base e apaga os arquivos dos trabalhadores
+template <typename Mascara>
+bool ConsolidarRetomada(const string& prefixo, const Retomada<Mascara>& r, const vector<string>& lidos) {
+    vector<pair<int, const TarefaParcial<Mascara>*>> parciais;
+    for (const auto& p : r.parciais) {
+        parciais.push_back({p.first, &p.second});
+    }
+    if (!GravarCheckpoint<Mascara>(prefixo + ".base", r.cabecalho, r.melhorCusto, r.melhorCaminho, r.concluida, parciais, r.nos)) {
+        cerr << "Erro ao gravar o checkpoint: " << prefixo << ".base" << endl;
+        return false;
+    }
+    for (const string& caminho : lidos) {
+        remove(caminho.c_str());
+    }
+    return true;
+}
+
+// Apaga os arquivos de checkpoint (depois que a busca termina, ou antes de uma busca nova sem --resume)
+inline void RemoverCheckpoint(const string& prefixo, const string& sufixo) {
+    remove((prefixo + ".base").c_str());
+    for (int i = 0; remove((prefixo + sufixo + to_string(i)).c_str()) == 0; i++) {
+    }
+}
+
+// Tarefas concluídas pelos trabalhadores de um processo e a melhor solução encontrada nelas. Uma thread sozinha
+// conclui tarefas espalhadas (as outras pegam as do meio), mas juntas elas concluem um intervalo contíguo.
+// Quem grava leva o conjunto inteiro e a melhor solução dele, então nenhuma tarefa marcada perde a sua solução.
+// Protegido por um mutex (e não por omp critical) porque os programas MPI incluem este arquivo sem -fopenmp.
+struct ProgressoComum {
+    mutex trava;
+    IntervalosTarefas concluidas;
+    int melhorCusto = INT_MAX;
+    vector<int> melhorCaminho;
+};
+
+// Ponto de controle de um trabalhador: passado para buscarCoberturas/continuarBusca no lugar de SemPontoControle
+template <typename Mascara>
+class PontoControle {
+    string arquivo;
+    CabecalhoCheckpoint cabecalho;
+    int64_t intervaloNs;
+    int64_t proximoNs;
+    uint64_t nos = 0;
+    ProgressoComum proprio;
+    ProgressoComum* comum;  // compartilhado pelas threads do processo, ou "proprio"
+    int tarefaAtual = -1;
+    TarefaParcial<Mascara> parcial;
+    // melhor solução que este trabalhador conhece, sempre com o caminho (o limite de outra thread não serve)
+    int melhorCusto = INT_MAX;
+    vector<int> melhorCaminho;
+    bool interrompida = false;
+
+    static int64_t agoraNs() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void anotarMelhor(int custo, const vector<int>& caminho) {
+        if (!caminho.empty() && custo < melhorCusto) {
+            melhorCusto = custo;
+            melhorCaminho = caminho;
+        }
+    }
+
+    void gravar(const EspacoBusca<Mascara>* espaco, int topo) {
+        vector<pair<int, const TarefaParcial<Mascara>*>> parciais;
+        if (espaco && topo > 0) {
+            parcial.pilha.assign(espaco->pilha, espaco->pilha + topo);
+            parcial.caminho.assign(espaco->caminho, espaco->caminho + espaco->pilha[topo - 1].profundidade);
+            parciais.push_back({tarefaAtual, &parcial});
+        }
+        IntervalosTarefas concluidas;
+        {
+            lock_guard<mutex> guarda(comum->trava);
+            concluidas = comum->concluidas;
+            anotarMelhor(comum->melhorCusto, comum->melhorCaminho);
+        }
+        if (!GravarCheckpoint<Mascara>(arquivo, cabecalho, melhorCusto, melhorCaminho, concluidas, parciais, nos)) {
+            cerr << "Erro ao gravar o checkpoint: " << arquivo << endl;
+        }
+        proximoNs = agoraNs() + intervaloNs;
+    }
+
+public:
+    PontoControle(const string& arquivo, const CabecalhoCheckpoint& cabecalho, double intervalo, ProgressoComum* comum = nullptr)
+        : arquivo(arquivo), cabecalho(cabecalho), intervaloNs((int64_t) (intervalo * 1e9)), proximoNs(agoraNs() + intervaloNs),
+          comum(comum ? comum : &proprio) {}
+
+    void iniciarTarefa(int tarefa) {
+        tarefaAtual = tarefa;
+    }
+
+    void concluirTarefa(int custo, const vector<int>& caminho) {
+        anotarMelhor(custo, caminho);
+        {
+            lock_guard<mutex> guarda(comum->trava);
+            comum->concluidas.inserir(tarefaAtual, tarefaAtual + 1);
+            if (!caminho.empty() && custo < comum->melhorCusto) {
+                comum->melhorCusto = custo;
+                comum->melhorCaminho = caminho;
+            }
+        }
+        tarefaAtual = -1;
+        if (pararSolicitado || agoraNs() >= proximoNs) {
+            gravar(nullptr, 0);
+        }
+    }
+
+    // Chamado pela busca a cada nó. Devolve true se a busca deve parar (sinal recebido; o estado já foi gravado).
+    bool no(const EspacoBusca<Mascara>& espaco, int topo, int custo, const vector<int>& caminho) {
+        if ((++nos & MASCARA_CHECKPOINT) != 0) {
+            return false;
+        }
+        bool parar = pararSolicitado;
+        if (!parar && agoraNs() < proximoNs) {
+            return false;
+        }
+        anotarMelhor(custo, caminho);
+        gravar(&espaco, topo);
+        interrompida = parar;
+        return parar;
+    }
+
+    // Grava o estado final do trabalhador. Se a busca foi interrompida, o arquivo já tem a pilha da tarefa
+    // em andamento e fica como está.
+    void finalizar() {
+        if (!interrompida) {
+            gravar(nullptr, 0);
+        }
+    }
+};
+
+// Tarefas que ainda faltam: primeiro as interrompidas (que já têm pilha), depois as que não começaram. As que
+// não começaram ficam em intervalos (o complemento das concluídas), e o item i é achado por busca binária.
+template <typename Mascara>
+struct TarefasPendentes {
+    vector<int> interrompidas;
+    vector<pair<int, int>> livres;  // intervalos [início, fim) de tarefas que não começaram
+    vector<int> antes;              // antes[k] = itens antes do intervalo livres[k]
+    int total = 0;
+
+    TarefasPendentes(const Retomada<Mascara>& r, int numTarefas) {
+        IntervalosTarefas feitas = r.concluida;
+        for (const auto& p : r.parciais) {
+            interrompidas.push_back(p.first);
+            feitas.inserir(p.first, p.first + 1);
+        }
+        total = interrompidas.size();
+        int t = 0;
+        feitas.intervalos.push_back({numTarefas, numTarefas});
+        for (const auto& x : feitas.intervalos) {
+            if (x.first > t) {
+                livres.push_back({t, x.first});
+                antes.push_back(total);
+                total += x.first - t;
+            }
+            t = max(t, x.second);
+        }
+    }
+
+    int size() const {
+        return total;
+    }
+
+    int operator[](int i) const {
+        if (i < (int) interrompidas.size()) {
+            return interrompidas[i];
+        }
+        int k = upper_bound(antes.begin(), antes.end(), i) - antes.begin() - 1;
+        return livres[k].first + (i - antes[k]);
+    }
+};
+
+// Executa (ou continua, se foi interrompida antes) uma tarefa. Sem ponto de controle é só buscarCoberturas.
+// Devolve false se a busca parou por causa de um sinal.
+template <typename Mascara>
+bool ExecutarTarefa(TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice, const ListaTarefas<Mascara>& tarefas,
+                    Mascara todas, int frota, const Retomada<Mascara>& r, int tarefa, EspacoBusca<Mascara>& espaco,
+                    int& melhorCusto, vector<int>& melhorCaminho, PontoControle<Mascara>* pc) {
+    if (!pc) {
+        return buscarCoberturas(rotas, indice, tarefas.tarefa(rotas, tarefa), todas, frota, espaco, melhorCusto, melhorCaminho);
+    }
+    pc->iniciarTarefa(tarefa);
+    bool completa;
+    auto parcial = r.parciais.find(tarefa);
+    if (parcial != r.parciais.end()) {
+        copy(parcial->second.pilha.begin(), parcial->second.pilha.end(), espaco.pilha);
+        copy(parcial->second.caminho.begin(), parcial->second.caminho.end(), espaco.caminho);
+        completa = continuarBusca(rotas, indice, todas, frota, espaco, (int) parcial->second.pilha.size(), melhorCusto, melhorCaminho, *pc);
+    } else {
+        completa = buscarCoberturas(rotas, indice, tarefas.tarefa(rotas, tarefa), todas, frota, espaco, melhorCusto, melhorCaminho, *pc);
+    }
+    if (completa) {
+        pc->concluirTarefa(melhorCusto, melhorCaminho);
+    }
+    return completa;
+}
+
+#endif
@@ -0,0 +1,592 @@
+#ifndef DECOMPOSICAO_H
+#define DECOMPOSICAO_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <memory>
+#include <omp.h>
+#include "buscaIterativa.h"
+#include "candidatos.h"
+#include "opcoes.h"
+#include "incremental.h"
+
+using namespace std;
+
+// Decomposição "agrupa primeiro, roteia depois" para instâncias grandes demais para a busca exaustiva:
+//  1. os clientes são divididos em grupos (k-medoides sobre a matriz de custos) de no máximo
+//     --tamanho-cluster clientes e com carga equilibrada em múltiplos da capacidade do veículo;
+//  2. cada grupo é resolvido de forma exata com a mesma busca dos outros solvers (candidatos.h e
+//     buscaIterativa.h), um grupo por thread;
+//  3. as fronteiras são reparadas resolvendo de novo, também de forma exata, a união de pares de grupos
+//     vizinhos; as rotas da solução da união são redistribuídas entre os dois grupos. Pares sem grupo em
+//     comum rodam em paralelo, e as passadas se repetem enquanto alguma melhora aparece (ou até --passadas).
+// A solução é ótima dentro de cada grupo e de cada par reparado, mas não necessariamente no total.
+// A frota não é limitada: cada grupo usa quantos veículos precisar.
+// Com MPI (decomposicaoMPI.cpp) os subproblemas dos passos 2 e 3 são divididos entre os processos como no
+// globalSearchMPI (rank, rank + size, ...), e dentro de cada processo entre as threads. Os resultados são
+// trocados entre todos, então cada processo segue com os mesmos grupos e toma as mesmas decisões no reparo.
+
+struct ParametrosDecomposicao {
+    int tamanhoCluster = 8; // clientes por grupo; a união de dois grupos vai para a busca exata no reparo
+    int passadas = 0;       // máximo de passadas de reparo das fronteiras (0 = até nenhum par melhorar)
+};
+
+// Grupo de clientes com a melhor solução conhecida para ele
+struct Cluster {
+    vector<int> clientes;
+    vector<vector<int>> rotas;
+    long long custo = 0;
+    int medoide = -1;
+    int versao = 0; // muda a cada vez que o grupo é alterado pelo reparo
+};
+
+// Separa as opções da decomposição e passa o resto para LerOpcoes
+inline bool LerOpcoesDecomposicao(int argc, char* argv[], Opcoes& op, ParametrosDecomposicao& pd) {
+    vector<char*> resto = {argv[0]};
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "--tamanho-cluster" || arg == "--passadas") && i + 1 < argc) {
+            (arg == "--tamanho-cluster" ? pd.tamanhoCluster : pd.passadas) = stoi(argv[++i]);
+        } else {
+            resto.push_back(argv[i]);
+        }
+    }
+    // a união de dois grupos precisa caber na máscara da busca exata
+    if (pd.tamanhoCluster < 1 || 2 * pd.tamanhoCluster > BitsMascara<uint128_t>() || pd.passadas < 0) {
+        return false;
+    }
+    return LerOpcoes((int) resto.size(), resto.data(), op);
+}
+
+// Distância usada para agrupar: a matriz é dirigida e pode não ter a aresta, então vale o menor sentido
+inline int DistanciaClientes(const MatrizCustos& m, int a, int b) {
+    return a == b ? 0 : min(m(a, b), m(b, a));
+}
+
+// Soma das distâncias de "candidato" aos membros do grupo (aresta inexistente pesa CUSTO_INFINITO)
+inline long long SomaDistancias(const MatrizCustos& m, int candidato, const vector<int>& membros) {
+    long long soma = 0;
+    for (int c : membros) {
+        soma += DistanciaClientes(m, candidato, c);
+    }
+    return soma;
+}
+
+// Atribui cada cliente a um medoide. Os clientes com mais a perder se não ficarem no grupo mais próximo
+// (maior diferença entre o segundo e o primeiro medoide) escolhem primeiro; um grupo não passa de
+// limiteClientes clientes e, enquanto houver outro com espaço, de limiteCarga de demanda.
+inline vector<int> AtribuirClientes(const MatrizCustos& m, const vector<int>& locais, map<int,int>& demanda,
+                                    const vector<int>& medoides, int limiteClientes, int limiteCarga) {
+    int k = medoides.size();
+    vector<int> grupo(locais.size(), -1), tamanho(k, 0), carga(k, 0);
+    vector<pair<long long, int>> ordem;
+    for (int i = 0; i < (int) locais.size(); i++) {
+        int primeiro = CUSTO_INFINITO, segundo = CUSTO_INFINITO;
+        for (int medoide : medoides) {
+            int d = DistanciaClientes(m, locais[i], medoide);
+            if (d < primeiro) {
+                segundo = primeiro;
+                primeiro = d;
+            } else if (d < segundo) {
+                segundo = d;
+            }
+        }
+        // os medoides ficam nos próprios grupos
+        bool ehMedoide = find(medoides.begin(), medoides.end(), locais[i]) != medoides.end();
+        ordem.push_back({ehMedoide ? LLONG_MAX : (long long) segundo - primeiro, i});
+    }
+    sort(ordem.begin(), ordem.end(), [](const pair<long long, int>& a, const pair<long long, int>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    for (const auto& item : ordem) {
+        int i = item.second, cliente = locais[i];
+        int melhor = -1, melhorSemCarga = -1;
+        for (int g = 0; g < k; g++) {
+            if (tamanho[g] >= limiteClientes) {
+                continue;
+            }
+            int d = DistanciaClientes(m, cliente, medoides[g]);
+            if (melhorSemCarga < 0 || d < DistanciaClientes(m, cliente, medoides[melhorSemCarga])) {
+                melhorSemCarga = g;
+            }
+            if (carga[g] + demanda[cliente] <= limiteCarga && (melhor < 0 || d < DistanciaClientes(m, cliente, medoides[melhor]))) {
+                melhor = g;
+            }
+        }
+        if (melhor < 0) {
+            melhor = melhorSemCarga;
+        }
+        grupo[i] = melhor;
+        tamanho[melhor]++;
+        carga[melhor] += demanda[cliente];
+    }
+    return grupo;
+}
+
+// k-medoides com capacidade: k é o menor número de grupos de até tamanhoCluster clientes, os medoides
+// iniciais são escolhidos pelo mais distante dos já escolhidos, e cada iteração reatribui os clientes e
+// troca o medoide de cada grupo pelo membro com a menor soma de distâncias aos outros.
+inline vector<Cluster> AgruparClientes(const MatrizCustos& m, const vector<int>& locais, map<int,int>& demanda, int capacidade,
+                                       int tamanhoCluster) {
+    int n = locais.size();
+    int k = (n + tamanhoCluster - 1) / tamanhoCluster;
+    long long demandaTotal = 0;
+    for (int cliente : locais) {
+        demandaTotal += demanda[cliente];
+    }
+    // cada grupo leva um número inteiro de cargas de veículo, o suficiente para a média dos grupos
+    long long veiculos = (demandaTotal + (long long) k * capacidade - 1) / ((long long) k * capacidade);
+    int limiteCarga = (int) min<long long>(INT_MAX, max(1LL, veiculos) * capacidade);
+
+    vector<int> medoides;
+    medoides.push_back(*min_element(locais.begin(), locais.end(), [&](int a, int b) {
+        return SomaDistancias(m, a, locais) < SomaDistancias(m, b, locais);
+    }));
+    while ((int) medoides.size() < k) {
+        int escolhido = -1;
+        long long maisDistante = -1;
+        for (int cliente : locais) {
+            long long perto = LLONG_MAX;
+            for (int medoide : medoides) {
+                perto = min(perto, (long long) DistanciaClientes(m, cliente, medoide));
+            }
+            if (perto > maisDistante) {
+                maisDistante = perto;
+                escolhido = cliente;
+            }
+        }
+        medoides.push_back(escolhido);
+    }
+
+    vector<int> grupo;
+    for (int iteracao = 0; iteracao < 50; iteracao++) {
+        grupo = AtribuirClientes(m, locais, demanda, medoides, tamanhoCluster, limiteCarga);
+        vector<vector<int>> membros(k);
+        for (int i = 0; i < n; i++) {
+            membros[grupo[i]].push_back(locais[i]);
+        }
+        bool mudou = false;
+        for (int g = 0; g < k; g++) {
+            int melhor = medoides[g];
+            long long melhorSoma = SomaDistancias(m, melhor, membros[g]);
+            for (int candidato : membros[g]) {
+                long long soma = SomaDistancias(m, candidato, membros[g]);
+                if (soma < melhorSoma) {
+                    melhorSoma = soma;
+                    melhor = candidato;
+                }
+            }
+            mudou |= melhor != medoides[g];
+            medoides[g] = melhor;
+        }
+        if (!mudou) {
+            break;
+        }
+    }
+
+    vector<Cluster> clusters(k);
+    for (int i = 0; i < n; i++) {
+        clusters[grupo[i]].clientes.push_back(locais[i]);
+    }
+    for (int g = 0; g < k; g++) {
+        clusters[g].medoide = medoides[g];
+    }
+    clusters.erase(remove_if(clusters.begin(), clusters.end(), [](const Cluster& c) { return c.clientes.empty(); }), clusters.end());
+    return clusters;
+}
+
+// Resolve de forma exata o subproblema com só estes clientes (frota ilimitada), aceitando só soluções de custo
+// menor que "limite". Devolve LLONG_MAX se não há solução abaixo do limite (ou se algum cliente não cabe em
+// nenhuma rota). Cada chamada usa as suas próprias estruturas, então várias threads podem resolver
+// subproblemas ao mesmo tempo.
+inline long long ResolverExato(vector<int> clientes, const map<int,int>& demandaTotal, int capacidade, const MatrizCustos& m,
+                               int deposito, vector<vector<int>>& solucao, long long limite = INT_MAX) {
+    sort(clientes.begin(), clientes.end());
+    map<int,int> demanda;
+    for (int cliente : clientes) {
+        demanda[cliente] = demandaTotal.at(cliente);
+    }
+    vector<vector<int>> rotas = GerarRotasCandidatas(clientes, demanda, capacidade, m);
+    long long custo = LLONG_MAX;
+    DespacharPorTamanho(clientes.size(), [&](auto zero) {
+        using Mascara = decltype(zero);
+        ReduzirCandidatos<Mascara>(rotas, clientes, m, deposito, false);
+        vector<RotaCompacta<Mascara>> compactas = CompactarRotas<Mascara>(rotas, clientes, demanda, m, deposito);
+        TabelaRotas<Mascara> tabela(compactas);
+        Mascara todas = MascaraTodos<Mascara>(clientes.size());
+        // sempre partição: RedistribuirRotas reparte os clientes das rotas entre os grupos, e um cliente
+        // repetido iria para os dois
+        IndiceRotas<Mascara> indice = IndexarRotas(tabela, clientes.size(), true);
+        unique_ptr<EspacoBusca<Mascara>> espaco(new EspacoBusca<Mascara>);
+        int melhorCusto = (int) min<long long>(limite, INT_MAX);
+        vector<int> melhorCaminho;
+        ListaTarefas<Mascara> tarefas = GerarTarefas(tabela, indice, todas, 0, 1);
+        for (int i = 0; i < tarefas.size(); i++) {
+            buscarCoberturas(tabela, indice, tarefas.tarefa(tabela, i), todas, 0, *espaco, melhorCusto, melhorCaminho);
+        }
+        if (!melhorCaminho.empty()) {
+            custo = melhorCusto;
+            solucao.clear();
+            for (int indice : melhorCaminho) {
+                solucao.push_back(rotas[indice]);
+            }
+        }
+    });
+    return custo;
+}
+
+#ifdef MPI_VERSION
+// Junta em todos os processos os resultados que cada um calculou (os subproblemas de índice rank, rank + size, ...).
+// As rotas vão achatadas: índice do subproblema, número de rotas e cada rota como "k c1 .. ck".
+inline void CompartilharSolucoes(int rank, int processos, vector<long long>& custos, vector<vector<vector<int>>>& solucoes) {
+    vector<int> meus;
+    for (int g = 0; g < (int) custos.size(); g++) {
+        if (g % processos != rank) {
+            custos[g] = LLONG_MIN;
+            continue;
+        }
+        meus.push_back(g);
+        meus.push_back(solucoes[g].size());
+        for (const auto& rota : solucoes[g]) {
+            meus.push_back(rota.size());
+            meus.insert(meus.end(), rota.begin(), rota.end());
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, custos.data(), custos.size(), MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+    int tamanho = meus.size();
+    vector<int> tamanhos(processos), deslocamentos(processos, 0);
+    MPI_Allgather(&tamanho, 1, MPI_INT, tamanhos.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int r = 1; r < processos; r++) {
+        deslocamentos[r] = deslocamentos[r - 1] + tamanhos[r - 1];
+    }
+    vector<int> todos(deslocamentos[processos - 1] + tamanhos[processos - 1]);
+    MPI_Allgatherv(meus.data(), tamanho, MPI_INT, todos.data(), tamanhos.data(), deslocamentos.data(), MPI_INT, MPI_COMM_WORLD);
+    for (size_t i = 0; i < todos.size();) {
+        vector<vector<int>>& solucao = solucoes[todos[i]];
+        int numRotas = todos[i + 1];
+        i += 2;
+        solucao.assign(numRotas, {});
+        for (int r = 0; r < numRotas; r++) {
+            solucao[r].assign(todos.begin() + i + 1, todos.begin() + i + 1 + todos[i]);
+            i += 1 + todos[i];
+        }
+    }
+}
+#endif
+
+// Resolve de forma exata subproblemas independentes (grupos de clientes, cada um com o seu limite), um por
+// thread. Com mais de um processo MPI cada processo fica com uma parte e no fim todos têm todos os resultados.
+struct Subproblemas {
+    const map<int,int>& demanda;
+    int capacidade;
+    const MatrizCustos& m;
+    int deposito;
+    int rank = 0;
+    int processos = 1;
+
+    void resolver(const vector<vector<int>>& grupos, const vector<long long>& limites, vector<long long>& custos,
+                  vector<vector<vector<int>>>& solucoes) const {
+        custos.assign(grupos.size(), LLONG_MAX);
+        solucoes.assign(grupos.size(), {});
+        // o tempo de cada subproblema varia bastante, daí o schedule(dynamic)
+        #pragma omp parallel for schedule(dynamic)
+        for (int g = rank; g < (int) grupos.size(); g += processos) {
+            custos[g] = ResolverExato(grupos[g], demanda, capacidade, m, deposito, solucoes[g], limites[g]);
+        }
+#ifdef MPI_VERSION
+        if (processos > 1) {
+            CompartilharSolucoes(rank, processos, custos, solucoes);
+        }
+#endif
+    }
+};
+
+inline int MedoideDe(const MatrizCustos& m, const vector<int>& clientes) {
+    return *min_element(clientes.begin(), clientes.end(), [&](int a, int b) {
+        return SomaDistancias(m, a, clientes) < SomaDistancias(m, b, clientes);
+    });
+}
+
+// Pares de grupos vizinhos: A e B são vizinhos se o cliente de outro grupo mais próximo de algum cliente de A
+// está em B (ou o contrário)
+inline set<pair<int, int>> ParesVizinhos(const MatrizCustos& m, const vector<Cluster>& clusters) {
+    vector<pair<int, int>> dono;
+    for (int g = 0; g < (int) clusters.size(); g++) {
+        for (int cliente : clusters[g].clientes) {
+            dono.push_back({cliente, g});
+        }
+    }
+    set<pair<int, int>> pares;
+    for (const auto& a : dono) {
+        int melhor = -1, melhorDistancia = CUSTO_INFINITO;
+        for (const auto& b : dono) {
+            int d = DistanciaClientes(m, a.first, b.first);
+            if (b.second != a.second && d < melhorDistancia) {
+                melhorDistancia = d;
+                melhor = b.second;
+            }
+        }
+        if (melhor >= 0) {
+            pares.insert({min(a.second, melhor), max(a.second, melhor)});
+        }
+    }
+    return pares;
+}
+
+// Divide as rotas da solução da união entre os dois grupos: cada rota vai para o medoide mais próximo da
+// soma dos seus clientes, com as rotas de preferência mais forte primeiro e sem passar de limite clientes
+// num grupo enquanto o outro tiver espaço
+inline void RedistribuirRotas(const MatrizCustos& m, int deposito, const vector<vector<int>>& rotas, int limite, Cluster& a, Cluster& b) {
+    vector<pair<long long, int>> ordem;
+    for (int r = 0; r < (int) rotas.size(); r++) {
+        long long da = SomaDistancias(m, a.medoide, rotas[r]), db = SomaDistancias(m, b.medoide, rotas[r]);
+        ordem.push_back({da - db, r});
+    }
+    sort(ordem.begin(), ordem.end(), [](const pair<long long, int>& x, const pair<long long, int>& y) {
+        long long ax = x.first < 0 ? -x.first : x.first, ay = y.first < 0 ? -y.first : y.first;
+        return ax != ay ? ax > ay : x.second < y.second;
+    });
+    Cluster novoA, novoB;
+    for (const auto& item : ordem) {
+        const vector<int>& rota = rotas[item.second];
+        bool paraA = item.first <= 0;
+        Cluster& preferido = paraA ? novoA : novoB;
+        Cluster& outro = paraA ? novoB : novoA;
+        Cluster& destino = (int) (preferido.clientes.size() + rota.size()) <= limite ||
+                           (int) (outro.clientes.size() + rota.size()) > limite ? preferido : outro;
+        destino.clientes.insert(destino.clientes.end(), rota.begin(), rota.end());
+        destino.rotas.push_back(rota);
+        destino.custo += m.custoRota(rota, deposito);
+    }
+    for (Cluster* c : {&novoA, &novoB}) {
+        if (!c->clientes.empty()) {
+            c->medoide = MedoideDe(m, c->clientes);
+        }
+    }
+    novoA.versao = a.versao + 1;
+    novoB.versao = b.versao + 1;
+    a = std::move(novoA);
+    b = std::move(novoB);
+}
+
+inline long long CustoTotal(const vector<Cluster>& clusters) {
+    long long total = 0;
+    for (const auto& c : clusters) {
+        total = c.custo == LLONG_MAX || total == LLONG_MAX ? LLONG_MAX : total + c.custo;
+    }
+    return total;
+}
+
+// Passadas de reparo das fronteiras. Em cada rodada os pares vizinhos ainda não tentados são escolhidos
+// gulosamente sem repetir grupo, e os pares escolhidos são resolvidos em paralelo. Um par só é tentado de
+// novo numa passada seguinte se um dos dois grupos mudou desde a última tentativa.
+inline void RepararFronteiras(const MatrizCustos& m, int deposito, const ParametrosDecomposicao& pd, const Subproblemas& sub,
+                              vector<Cluster>& clusters) {
+    map<pair<int, int>, pair<int, int>> tentado; // par -> versões dos dois grupos na última tentativa
+    // cada melhoria diminui o custo total, que é inteiro, então sem limite as passadas também terminam
+    for (int passada = 1; pd.passadas == 0 || passada <= pd.passadas; passada++) {
+        set<pair<int, int>> pendentes = ParesVizinhos(m, clusters);
+        for (auto it = pendentes.begin(); it != pendentes.end();) {
+            auto t = tentado.find(*it);
+            bool igual = t != tentado.end() && t->second == make_pair(clusters[it->first].versao, clusters[it->second].versao);
+            it = igual ? pendentes.erase(it) : next(it);
+        }
+        int melhorias = 0;
+        while (!pendentes.empty()) {
+            vector<pair<int, int>> rodada;
+            vector<char> usado(clusters.size(), 0);
+            for (auto it = pendentes.begin(); it != pendentes.end();) {
+                // a redistribuição pode deixar um grupo acima do limite; a união ainda precisa ser tratável
+                if (clusters[it->first].clientes.size() + clusters[it->second].clientes.size() > 2 * (size_t) pd.tamanhoCluster) {
+                    it = pendentes.erase(it);
+                } else if (!usado[it->first] && !usado[it->second]) {
+                    usado[it->first] = usado[it->second] = 1;
+                    rodada.push_back(*it);
+                    it = pendentes.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            vector<vector<int>> unioes;
+            vector<long long> limites;
+            for (const auto& par : rodada) {
+                const Cluster& a = clusters[par.first];
+                const Cluster& b = clusters[par.second];
+                unioes.push_back(a.clientes);
+                unioes.back().insert(unioes.back().end(), b.clientes.begin(), b.clientes.end());
+                // só interessa uma solução estritamente melhor que a atual do par, que serve de limite para a busca
+                limites.push_back(a.custo + b.custo);
+            }
+            vector<long long> custos;
+            vector<vector<vector<int>>> solucoes;
+            sub.resolver(unioes, limites, custos, solucoes);
+            for (int p = 0; p < (int) rodada.size(); p++) {
+                Cluster& a = clusters[rodada[p].first];
+                Cluster& b = clusters[rodada[p].second];
+                if (custos[p] < a.custo + b.custo) {
+                    RedistribuirRotas(m, deposito, solucoes[p], pd.tamanhoCluster, a, b);
+                    melhorias++;
+                }
+                tentado[rodada[p]] = {a.versao, b.versao};
+            }
+        }
+        if (sub.rank == 0) {
+            cout << "Reparo: passada " << passada << ", " << melhorias << " pares melhorados, custo " << CustoTotal(clusters) << endl;
+        }
+        if (melhorias == 0) {
+            break;
+        }
+    }
+}
+
+inline void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes) {
+    ifstream arquivo;
+    arquivo.open(file);
+    if (arquivo.is_open()) {
+        arquivo >> numNos;
+        // Populando a lista de demandas dos locais
+        for (int i = 0; i < numNos - 1; i++) {
+            int id_no, demanda_no;
+            arquivo >> id_no;
+            arquivo >> demanda_no;
+            demanda[id_no] = demanda_no;
+        }
+        int K; // número de arestas
+        arquivo >> K;
+        for (int i = 0; i < K; i++) {
+            int id_no1, id_no2, custo;
+            arquivo >> id_no1;
+            arquivo >> id_no2;
+            arquivo >> custo;
+            arestas.push_back(make_tuple(id_no1, id_no2, custo));
+        }
+        LerParametrosArquivo(arquivo, opcoes);
+    }
+    arquivo.close();
+}
+
+// Corpo comum do decomposicaoGlobalSearch (um processo só) e do decomposicaoMPI. Todos os processos fazem o
+// mesmo agrupamento e recebem todos os resultados; só o rank 0 imprime e grava o estado.
+inline int ExecutarDecomposicao(int argc, char* argv[], int rank, int processos) {
+    auto start = std::chrono::high_resolution_clock::now();
+    Opcoes opcoes;
+    ParametrosDecomposicao parametros;
+    if (!LerOpcoesDecomposicao(argc, argv, opcoes, parametros)) {
+        if (rank == 0) {
+            ImprimirUso(argv[0]);
+            cout << "       (decomposicao) [--tamanho-cluster N] [--passadas P]" << endl;
+        }
+        return 1;
+    }
+    string recusa;
+    if (!opcoes.checkpoint.empty()) {
+        recusa = "A decomposicao nao grava checkpoint: cada subproblema e resolvido em poucos segundos";
+    } else if (!opcoes.cache.empty()) {
+        // o cache só guarda soluções ótimas
+        recusa = "A decomposicao nao usa --cache: a solucao dela nao e necessariamente otima";
+    } else if (!opcoes.rotasDisco.empty()) {
+        // cada subproblema tem poucas rotas
+        recusa = "A decomposicao nao usa --rotas-disco: as rotas de cada cluster cabem na memoria";
+    }
+    if (!recusa.empty()) {
+        if (rank == 0) {
+            cout << recusa << endl;
+        }
+        return 1;
+    }
+    map<int,int> demanda;
+    vector<tuple<int, int , int>> arestas;
+    // a instância vem do arquivo ou, na reotimização incremental, do estado salvo com o delta aplicado
+    EstadoResolvido estado;
+    int numNos = 0;
+    if (!opcoes.estado.empty()) {
+        if (!CarregarEstado(opcoes, estado)) {
+            return 1;
+        }
+        demanda = estado.demanda;
+        arestas = estado.arestas;
+        numNos = estado.numNos;
+    } else {
+        LerGrafo(opcoes.arquivo, demanda, arestas, numNos, opcoes);
+    }
+    AplicarPadroes(opcoes, 10);
+    vector<int> locais = ClientesSemDeposito(numNos, opcoes.deposito);
+    int capacidade = opcoes.capacidade;
+    int deposito = opcoes.deposito;
+    MatrizCustos matriz(numNos, arestas);
+    Subproblemas sub{demanda, capacidade, matriz, deposito, rank, processos};
+    if (rank == 0) {
+        if (opcoes.frota > 0) {
+            cout << "Aviso: a decomposicao nao limita a frota (" << opcoes.frota << " veiculos)" << endl;
+        }
+        cout << "Local: " << locais.size() << endl;
+    }
+
+    // 1. agrupamento
+    vector<Cluster> clusters = AgruparClientes(matriz, locais, demanda, capacidade, parametros.tamanhoCluster);
+    if (rank == 0) {
+        cout << "Clusters: " << clusters.size() << endl;
+    }
+
+    // 2. cada grupo é um subproblema independente
+    vector<vector<int>> grupos;
+    for (const auto& c : clusters) {
+        grupos.push_back(c.clientes);
+    }
+    vector<long long> custos;
+    vector<vector<vector<int>>> solucoes;
+    sub.resolver(grupos, vector<long long>(grupos.size(), INT_MAX), custos, solucoes);
+    for (int g = 0; g < (int) clusters.size(); g++) {
+        clusters[g].custo = custos[g];
+        clusters[g].rotas = solucoes[g];
+    }
+    long long custo = CustoTotal(clusters);
+    if (custo == LLONG_MAX) {
+        if (rank == 0) {
+            cout << "Nenhuma solucao respeita a capacidade informada" << endl;
+        }
+        return 1;
+    }
+    if (rank == 0) {
+        cout << "Custo por cluster: " << custo << endl;
+    }
+
+    // 3. reparo das fronteiras
+    RepararFronteiras(matriz, deposito, parametros, sub, clusters);
+    if (rank != 0) {
+        return 0;
+    }
+
+    vector<vector<int>> solucao;
+    for (const auto& c : clusters) {
+        solucao.insert(solucao.end(), c.rotas.begin(), c.rotas.end());
+    }
+    cout << "Melhor combinação de rotas:" << endl;
+    for (const auto& rota : solucao) {
+        cout << "{ ";
+        for (int cidade : rota) {
+            cout << cidade << " ";
+        }
+        cout << "} com custo: " << matriz.custoRota(rota, deposito) << endl;
+    }
+    cout << "Veiculos: " << solucao.size() << endl;
+    cout << "Menor custo: " << CustoTotal(clusters) << endl;
+    // o estado gravado pode servir de limite inicial para os solvers exatos (--estado)
+    if (!opcoes.salvarEstado.empty()) {
+        SalvarExecucao(opcoes, numNos, demanda, arestas, solucao, estado);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,5 @@
+#include "decomposicao.h"
+
+int main(int argc, char* argv[]){
+    return ExecutarDecomposicao(argc, argv, 0, 1);
+}
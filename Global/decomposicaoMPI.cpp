@@ -0,0 +1,14 @@
+#include <mpi.h>
+#include "decomposicao.h"
+
+// Mesma decomposição do decomposicaoGlobalSearch, com os subproblemas (clusters e pares do reparo) divididos
+// entre os processos e, dentro de cada processo, entre as threads
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int codigo = ExecutarDecomposicao(argc, argv, rank, size);
+    MPI_Finalize();
+    return codigo;
+}
@@ -0,0 +1,344 @@
+#ifndef FEIXE_H
+#define FEIXE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <omp.h>
+#include "candidatos.h"
+#include "opcoes.h"
+
+using namespace std;
+
+// Busca em feixe: meio-termo ajustável entre a busca exaustiva e a heurística gulosa.
+//
+// Uma solução parcial é o conjunto de clientes já atendidos, o último cliente da rota aberta e a carga dela
+// (as rotas anteriores já voltaram ao depósito). Cada nível atende mais um cliente, estendendo a rota aberta
+// ou fechando-a e abrindo outra, então depois de n níveis todas as soluções do feixe estão completas.
+// Em cada nível:
+//  - cada estado do feixe gera as suas --candidatos extensões mais promissoras (0 = todas), em paralelo;
+//  - estados iguais (mesmos clientes atendidos, último cliente e carga; com frota limitada, também o número
+//    de rotas) vindos de pais diferentes são juntados numa tabela hash, ficando o de menor custo. O custo
+//    do resto da solução só depende dessa chave, então nada se perde;
+//  - ficam os --largura estados de menor custo mais estimativa, em que a estimativa soma, para cada cliente
+//    ainda não atendido, a aresta mais barata que chega nele (um limite inferior do que falta).
+// Com largura e candidatos ilimitados a busca é exata (programação dinâmica sobre as rotas); a largura
+// controla diretamente a troca entre qualidade e tempo.
+// Os clientes atendidos ficam numa máscara de tamanho variável (palavras de 64 bits), então não há o limite
+// de 128 clientes da busca exata; o limite prático é a matriz de custos densa. A chave da tabela usa hashing
+// de Zobrist, atualizado em O(1) a cada extensão. Os filhos são divididos pelo hash em partições (tantas quanto
+// o máximo de threads), e cada thread junta e seleciona as suas; o resultado não depende do número de threads.
+
+struct ParametrosFeixe {
+    int largura = 1000;  // estados mantidos por nível
+    int candidatos = 10; // extensões geradas por estado (0 = todas)
+};
+
+// Separa as opções da busca em feixe e passa o resto para LerOpcoes
+inline bool LerOpcoesFeixe(int argc, char* argv[], Opcoes& op, ParametrosFeixe& pf) {
+    vector<char*> resto = {argv[0]};
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "--largura" || arg == "--candidatos") && i + 1 < argc) {
+            (arg == "--largura" ? pf.largura : pf.candidatos) = stoi(argv[++i]);
+        } else {
+            resto.push_back(argv[i]);
+        }
+    }
+    if (pf.largura < 1 || pf.candidatos < 0) {
+        return false;
+    }
+    return LerOpcoes((int) resto.size(), resto.data(), op);
+}
+
+// Estado do feixe; a máscara dos clientes atendidos fica num vetor à parte, "palavras" por estado
+struct EstadoFeixe {
+    long long custo;     // rotas fechadas mais a rota aberta até "ultimo"
+    long long restante;  // soma da aresta mais barata que chega em cada cliente não atendido
+    uint64_t hashMascara;
+    int ultimo;          // nó (o depósito só no estado inicial)
+    int carga;
+    int rotas;
+};
+
+// Filho gerado a partir de feixe[pai] atendendo o cliente de índice "cliente" (posição em locais)
+struct ExpansaoFeixe {
+    long long custo;
+    long long estimativa; // custo + restante do filho
+    uint64_t hashMascara;
+    uint64_t chave;
+    int pai;
+    int cliente;
+    int carga;
+    int rotas;
+    bool novaRota;
+};
+
+// Ordem total dos filhos (para a seleção não depender da ordem em que as threads os geraram)
+inline bool MelhorExpansao(const ExpansaoFeixe& a, const ExpansaoFeixe& b) {
+    if (a.estimativa != b.estimativa) {
+        return a.estimativa < b.estimativa;
+    }
+    if (a.custo != b.custo) {
+        return a.custo < b.custo;
+    }
+    if (a.pai != b.pai) {
+        return a.pai < b.pai;
+    }
+    if (a.cliente != b.cliente) {
+        return a.cliente < b.cliente;
+    }
+    return a.novaRota < b.novaRota;
+}
+
+// De onde veio cada estado, para remontar as rotas no fim
+struct PassoFeixe {
+    int pai;
+    int cliente;
+    bool novaRota;
+};
+
+struct ResultadoFeixe {
+    vector<vector<int>> rotas;
+    long long custo = LLONG_MAX; // LLONG_MAX = o feixe não chegou a uma solução completa
+    long long expandidos = 0;
+};
+
+inline uint64_t MisturarHash(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline ResultadoFeixe BuscaEmFeixe(const MatrizCustos& m, const vector<int>& locais, map<int,int>& demanda, int capacidade,
+                                   int frota, int deposito, const ParametrosFeixe& parametros) {
+    ResultadoFeixe resultado;
+    int n = locais.size();
+    int palavras = max(1, (n + 63) / 64);
+    vector<int> dem(n);
+    vector<long long> minEntrada(n, CUSTO_INFINITO);
+    vector<uint64_t> zobrist(n);
+    long long restanteInicial = 0;
+    for (int j = 0; j < n; j++) {
+        dem[j] = demanda[locais[j]];
+        for (int i = 0; i < m.n; i++) {
+            if (i != locais[j]) {
+                minEntrada[j] = min<long long>(minEntrada[j], m(i, locais[j]));
+            }
+        }
+        // cliente que não cabe num veículo ou em que nenhuma aresta chega: não há solução
+        if (dem[j] > capacidade || minEntrada[j] >= CUSTO_INFINITO) {
+            return resultado;
+        }
+        restanteInicial += minEntrada[j];
+        zobrist[j] = MisturarHash(j + 1);
+    }
+
+    // para cada nó, os clientes com aresta saindo dele, do mais ao menos promissor (custo da aresta menos o
+    // que ela tira da estimativa): as extensões de um estado são os primeiros ainda não atendidos que cabem
+    struct Vizinho {
+        long long chave;
+        int cliente;
+        bool operator<(const Vizinho& o) const {
+            return chave != o.chave ? chave < o.chave : cliente < o.cliente;
+        }
+    };
+    vector<vector<Vizinho>> vizinhos(m.n);
+    #pragma omp parallel for schedule(dynamic)
+    for (int no = 0; no < m.n; no++) {
+        for (int j = 0; j < n; j++) {
+            if (locais[j] != no && m(no, locais[j]) < CUSTO_INFINITO) {
+                vizinhos[no].push_back({m(no, locais[j]) - minEntrada[j], j});
+            }
+        }
+        sort(vizinhos[no].begin(), vizinhos[no].end());
+    }
+
+    if (n == 0) {
+        resultado.custo = 0;
+        return resultado;
+    }
+    // o número de partições é fixo; o runtime pode dar menos threads à região (OMP_DYNAMIC, OMP_THREAD_LIMIT),
+    // então cada thread cuida das partições t, t + equipe, ... e todos os baldes são esvaziados fora dela
+    int particoes = omp_get_max_threads();
+    long long expandidos = 0;
+    vector<EstadoFeixe> feixe = {{0, restanteInicial, 0, deposito, 0, 0}};
+    vector<uint64_t> mascaras(palavras, 0);
+    vector<vector<PassoFeixe>> passos(n);
+    // baldes[t][p]: filhos gerados pela thread t que caem na partição p
+    vector<vector<vector<ExpansaoFeixe>>> baldes(particoes, vector<vector<ExpansaoFeixe>>(particoes));
+    vector<vector<ExpansaoFeixe>> escolhidos(particoes);
+    vector<ExpansaoFeixe> proximo;
+
+    for (int nivel = 0; nivel < n; nivel++) {
+        for (auto& daThread : baldes) {
+            for (auto& balde : daThread) {
+                balde.clear();
+            }
+        }
+        #pragma omp parallel num_threads(particoes) reduction(+:expandidos)
+        {
+            int t = omp_get_thread_num();
+            int equipe = omp_get_num_threads();
+            vector<ExpansaoFeixe> filhos;
+            #pragma omp for schedule(dynamic, 16)
+            for (int e = 0; e < (int) feixe.size(); e++) {
+                const EstadoFeixe& s = feixe[e];
+                const uint64_t* mascara = &mascaras[(size_t) e * palavras];
+                filhos.clear();
+                auto gerar = [&](int origem, long long extra, bool nova) {
+                    int achados = 0;
+                    for (const Vizinho& v : vizinhos[origem]) {
+                        if (parametros.candidatos > 0 && achados == parametros.candidatos) {
+                            break;
+                        }
+                        int j = v.cliente;
+                        int carga = (nova ? 0 : s.carga) + dem[j];
+                        if (((mascara[j >> 6] >> (j & 63)) & 1) || carga > capacidade) {
+                            continue;
+                        }
+                        achados++;
+                        ExpansaoFeixe x;
+                        x.custo = s.custo + extra + m(origem, locais[j]);
+                        x.estimativa = x.custo + s.restante - minEntrada[j];
+                        x.hashMascara = s.hashMascara ^ zobrist[j];
+                        x.rotas = s.rotas + (nova ? 1 : 0);
+                        x.chave = MisturarHash(x.hashMascara ^ MisturarHash(((uint64_t) j << 32) | (uint32_t) carga)
+                                               ^ (frota > 0 ? MisturarHash(~(uint64_t) x.rotas) : 0));
+                        x.pai = e;
+                        x.cliente = j;
+                        x.carga = carga;
+                        x.novaRota = nova;
+                        filhos.push_back(x);
+                    }
+                };
+                if (s.ultimo == deposito) {
+                    gerar(deposito, 0, true);
+                } else {
+                    gerar(s.ultimo, 0, false);
+                    int volta = m(s.ultimo, deposito);
+                    if (volta < CUSTO_INFINITO && (frota == 0 || s.rotas < frota)) {
+                        gerar(deposito, volta, true);
+                    }
+                }
+                expandidos++;
+                if (parametros.candidatos > 0 && (int) filhos.size() > parametros.candidatos) {
+                    nth_element(filhos.begin(), filhos.begin() + parametros.candidatos, filhos.end(), MelhorExpansao);
+                    filhos.resize(parametros.candidatos);
+                }
+                for (const ExpansaoFeixe& x : filhos) {
+                    baldes[t][x.chave % particoes].push_back(x);
+                }
+            }
+            // (barreira implícita do omp for) cada partição tem os seus estados repetidos juntados e fica com os
+            // "largura" melhores dela
+            for (int p = t; p < particoes; p += equipe) {
+                vector<ExpansaoFeixe>& sel = escolhidos[p];
+                sel.clear();
+                size_t total = 0;
+                for (int u = 0; u < particoes; u++) {
+                    total += baldes[u][p].size();
+                }
+                size_t tamanho = 1;
+                while (tamanho < 2 * total) {
+                    tamanho <<= 1;
+                }
+                vector<int> tabela(tamanho, -1);
+                for (int u = 0; u < particoes; u++) {
+                    for (const ExpansaoFeixe& x : baldes[u][p]) {
+                        // os bits baixos da chave escolheram a partição; a posição usa os altos
+                        size_t pos = (x.chave >> 32) & (tamanho - 1);
+                        while (true) {
+                            int i = tabela[pos];
+                            if (i < 0) {
+                                tabela[pos] = sel.size();
+                                sel.push_back(x);
+                                break;
+                            }
+                            ExpansaoFeixe& y = sel[i];
+                            // mesmo cliente novo, então as máscaras são iguais se as dos pais forem
+                            if (y.chave == x.chave && y.cliente == x.cliente && y.carga == x.carga
+                                && (frota == 0 || y.rotas == x.rotas)
+                                && memcmp(&mascaras[(size_t) x.pai * palavras], &mascaras[(size_t) y.pai * palavras],
+                                          palavras * sizeof(uint64_t)) == 0) {
+                                if (MelhorExpansao(x, y)) {
+                                    y = x;
+                                }
+                                break;
+                            }
+                            pos = (pos + 1) & (tamanho - 1);
+                        }
+                    }
+                }
+                if ((int) sel.size() > parametros.largura) {
+                    nth_element(sel.begin(), sel.begin() + parametros.largura, sel.end(), MelhorExpansao);
+                    sel.resize(parametros.largura);
+                }
+            }
+        }
+
+        proximo.clear();
+        for (const auto& sel : escolhidos) {
+            proximo.insert(proximo.end(), sel.begin(), sel.end());
+        }
+        if (proximo.empty()) {
+            // nenhum estado consegue atender mais um cliente (arestas faltando ou frota esgotada)
+            return resultado;
+        }
+        if ((int) proximo.size() > parametros.largura) {
+            nth_element(proximo.begin(), proximo.begin() + parametros.largura, proximo.end(), MelhorExpansao);
+            proximo.resize(parametros.largura);
+        }
+        sort(proximo.begin(), proximo.end(), MelhorExpansao);
+
+        vector<EstadoFeixe> novoFeixe(proximo.size());
+        vector<uint64_t> novasMascaras(proximo.size() * palavras);
+        passos[nivel].resize(proximo.size());
+        #pragma omp parallel for
+        for (int k = 0; k < (int) proximo.size(); k++) {
+            const ExpansaoFeixe& x = proximo[k];
+            novoFeixe[k] = {x.custo, feixe[x.pai].restante - minEntrada[x.cliente], x.hashMascara, locais[x.cliente], x.carga, x.rotas};
+            uint64_t* mascara = &novasMascaras[(size_t) k * palavras];
+            memcpy(mascara, &mascaras[(size_t) x.pai * palavras], palavras * sizeof(uint64_t));
+            mascara[x.cliente >> 6] |= 1ULL << (x.cliente & 63);
+            passos[nivel][k] = {x.pai, x.cliente, x.novaRota};
+        }
+        feixe.swap(novoFeixe);
+        mascaras.swap(novasMascaras);
+    }
+
+    resultado.expandidos = expandidos;
+    // todos os clientes atendidos: falta só voltar ao depósito
+    int melhor = -1;
+    for (int e = 0; e < (int) feixe.size(); e++) {
+        int volta = m(feixe[e].ultimo, deposito);
+        if (volta < CUSTO_INFINITO && feixe[e].custo + volta < resultado.custo) {
+            resultado.custo = feixe[e].custo + volta;
+            melhor = e;
+        }
+    }
+    if (melhor < 0) {
+        return resultado;
+    }
+    vector<int> rota;
+    for (int nivel = n - 1, e = melhor; nivel >= 0; nivel--) {
+        const PassoFeixe& passo = passos[nivel][e];
+        rota.push_back(locais[passo.cliente]);
+        if (passo.novaRota) {
+            reverse(rota.begin(), rota.end());
+            resultado.rotas.push_back(rota);
+            rota.clear();
+        }
+        e = passo.pai;
+    }
+    reverse(resultado.rotas.begin(), resultado.rotas.end());
+    return resultado;
+}
+
+#endif
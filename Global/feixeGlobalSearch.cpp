@@ -0,0 +1,105 @@
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <omp.h>
+#include "candidatos.h"
+#include "opcoes.h"
+#include "incremental.h"
+#include "feixe.h"
+
+using namespace std;
+
+void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes);
+
+int main(int argc, char* argv[]){
+    auto start = std::chrono::high_resolution_clock::now();
+    Opcoes opcoes;
+    ParametrosFeixe parametros;
+    if (!LerOpcoesFeixe(argc, argv, opcoes, parametros)) {
+        ImprimirUso(argv[0]);
+        cout << "       (feixe) [--largura W] [--candidatos C]" << endl;
+        return 1;
+    }
+    // cada execução termina em n níveis; não há busca longa para interromper nem solução ótima para guardar
+    if (!opcoes.checkpoint.empty() || !opcoes.cache.empty() || !opcoes.rotasDisco.empty() || opcoes.relaxacao) {
+        cout << "A busca em feixe nao usa --checkpoint, --cache, --rotas-disco nem --relaxacao" << endl;
+        return 1;
+    }
+    map<int,int> demanda;
+    vector<tuple<int, int , int>> arestas;
+    // a instância vem do arquivo ou, na reotimização incremental, do estado salvo com o delta aplicado
+    EstadoResolvido estado;
+    int numNos = 0;
+    if (!opcoes.estado.empty()) {
+        if (!CarregarEstado(opcoes, estado)) {
+            return 1;
+        }
+        demanda = estado.demanda;
+        arestas = estado.arestas;
+        numNos = estado.numNos;
+    } else {
+        LerGrafo(opcoes.arquivo, demanda, arestas, numNos, opcoes);
+    }
+    AplicarPadroes(opcoes, 10);
+    vector<int> locais = ClientesSemDeposito(numNos, opcoes.deposito);
+    cout << "Local: " << locais.size() << endl;
+    cout << "Largura do feixe: " << parametros.largura << endl;
+    MatrizCustos matriz(numNos, arestas);
+
+    ResultadoFeixe resultado = BuscaEmFeixe(matriz, locais, demanda, opcoes.capacidade, opcoes.frota, opcoes.deposito, parametros);
+    cout << "Estados expandidos: " << resultado.expandidos << endl;
+    if (resultado.custo == LLONG_MAX) {
+        cout << "Nenhuma solucao encontrada pelo feixe (capacidade, frota ou arestas)" << endl;
+        return 1;
+    }
+    cout << "Melhor combinação de rotas:" << endl;
+    for (const auto& rota : resultado.rotas) {
+        cout << "{ ";
+        for (int cidade : rota) {
+            cout << cidade << " ";
+        }
+        cout << "} com custo: " << matriz.custoRota(rota, opcoes.deposito) << endl;
+    }
+    cout << "Veiculos: " << resultado.rotas.size() << endl;
+    cout << "Menor custo: " << resultado.custo << endl;
+    // o estado gravado pode servir de limite inicial para os solvers exatos (--estado)
+    if (!opcoes.salvarEstado.empty()) {
+        SalvarExecucao(opcoes, numNos, demanda, arestas, resultado.rotas, estado);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
+    return 0;
+}
+
+void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes) {
+    ifstream arquivo;
+    arquivo.open(file);
+    if (arquivo.is_open()) {
+        arquivo >> numNos;
+        // Populando a lista de demandas dos locais
+        for (int i = 0; i < numNos - 1; i++) {
+            int id_no, demanda_no;
+            arquivo >> id_no;
+            arquivo >> demanda_no;
+            demanda[id_no] = demanda_no;
+        }
+        int K; // número de arestas
+        arquivo >> K;
+        for (int i = 0; i < K; i++) {
+            int id_no1, id_no2, custo;
+            arquivo >> id_no1;
+            arquivo >> id_no2;
+            arquivo >> custo;
+            arestas.push_back(make_tuple(id_no1, id_no2, custo));
+        }
+        LerParametrosArquivo(arquivo, opcoes);
+    }
+    arquivo.close();
+}
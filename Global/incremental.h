@@ -0,0 +1,295 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <tuple>
+#include <algorithm>
+#include <climits>
+#include "candidatos.h"
+#include "opcoes.h"
+
+using namespace std;
+
+// Reotimização incremental: em vez de montar tudo do zero quando só algumas demandas ou custos mudam,
+// o solver grava (--salvar-estado) a instância, os parâmetros, a melhor ordem de cada rota candidata já
+// calculada e a melhor solução, e a execução seguinte parte desse estado (--estado) com um delta (--delta).
+//
+// Formato do delta, uma mudança por linha (linhas começando com # são ignoradas):
+//   DEMANDA id valor      nova demanda do cliente
+//   ARESTA origem destino custo   aresta nova ou custo novo de uma aresta existente
+//   REMOVER origem destino        remove a aresta
+//
+// O que é reaproveitado:
+//  - a melhor ordem e o custo de cada rota (o Held-Karp, a parte cara da geração) só dependem das arestas
+//    entre os clientes da rota e o depósito, então só as rotas que passam pelas duas pontas de uma aresta
+//    alterada são descartadas do cache; mudança de demanda não invalida nenhuma ordem, só muda quais rotas
+//    respeitam a capacidade, e isso a geração (barata) refaz;
+//  - a solução anterior, recalculada com os dados novos, vira o limite inicial da busca se ainda for válida.
+
+const char* const CABECALHO_ESTADO = "ESTADO_VRP 1";
+
+struct EstadoResolvido {
+    int capacidade = -1;
+    int frota = -1;
+    int deposito = -1;
+    int numNos = 0;
+    map<int,int> demanda;
+    vector<tuple<int, int, int>> arestas;
+    CacheOrdens cache;
+    vector<vector<int>> solucao;
+};
+
+inline bool LerEstado(const string& caminho, EstadoResolvido& e) {
+    ifstream arquivo(caminho);
+    string linha;
+    if (!getline(arquivo, linha) || linha != CABECALHO_ESTADO) {
+        cerr << "Arquivo de estado invalido: " << caminho << endl;
+        return false;
+    }
+    string chave;
+    int quantidade;
+    arquivo >> chave >> e.capacidade >> e.frota >> e.deposito;
+    arquivo >> chave >> e.numNos;
+    arquivo >> chave >> quantidade;
+    for (int i = 0; i < quantidade; i++) {
+        int id, d;
+        arquivo >> id >> d;
+        e.demanda[id] = d;
+    }
+    arquivo >> chave >> quantidade;
+    e.arestas.reserve(quantidade);
+    for (int i = 0; i < quantidade; i++) {
+        int origem, destino, custo;
+        arquivo >> origem >> destino >> custo;
+        e.arestas.push_back(make_tuple(origem, destino, custo));
+    }
+    arquivo >> chave >> quantidade;
+    for (int i = 0; i < quantidade; i++) {
+        OrdemCacheada o;
+        int k;
+        arquivo >> o.custo >> k;
+        o.ordem.resize(k);
+        for (int& cliente : o.ordem) {
+            arquivo >> cliente;
+        }
+        vector<int> chaveRota = o.ordem;
+        sort(chaveRota.begin(), chaveRota.end());
+        e.cache[chaveRota] = o;
+    }
+    arquivo >> chave >> quantidade;
+    e.solucao.assign(quantidade, {});
+    for (auto& rota : e.solucao) {
+        int k;
+        arquivo >> k;
+        rota.resize(k);
+        for (int& cliente : rota) {
+            arquivo >> cliente;
+        }
+    }
+    if (arquivo.fail()) {
+        cerr << "Arquivo de estado incompleto: " << caminho << endl;
+        return false;
+    }
+    return true;
+}
+
+inline bool SalvarEstado(const string& caminho, const EstadoResolvido& e) {
+    ofstream arquivo(caminho);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao abrir o arquivo de estado: " << caminho << endl;
+        return false;
+    }
+    arquivo << CABECALHO_ESTADO << "\n";
+    arquivo << "PARAMETROS " << e.capacidade << " " << e.frota << " " << e.deposito << "\n";
+    arquivo << "NOS " << e.numNos << "\n";
+    arquivo << "DEMANDAS " << e.demanda.size() << "\n";
+    for (const auto& d : e.demanda) {
+        arquivo << d.first << " " << d.second << "\n";
+    }
+    arquivo << "ARESTAS " << e.arestas.size() << "\n";
+    for (const auto& a : e.arestas) {
+        arquivo << get<0>(a) << " " << get<1>(a) << " " << get<2>(a) << "\n";
+    }
+    arquivo << "ORDENS " << e.cache.size() << "\n";
+    for (const auto& entrada : e.cache) {
+        arquivo << entrada.second.custo << " " << entrada.second.ordem.size();
+        for (int cliente : entrada.second.ordem) {
+            arquivo << " " << cliente;
+        }
+        arquivo << "\n";
+    }
+    arquivo << "SOLUCAO " << e.solucao.size() << "\n";
+    for (const auto& rota : e.solucao) {
+        arquivo << rota.size();
+        for (int cliente : rota) {
+            arquivo << " " << cliente;
+        }
+        arquivo << "\n";
+    }
+    return true;
+}
+
+// Descarta do cache as rotas cuja ordem pode ter mudado com a alteração da aresta origem -> destino:
+// as que passam pelas duas pontas (ou pela ponta que não é o depósito)
+inline int InvalidarAresta(CacheOrdens& cache, int origem, int destino, int deposito) {
+    int removidas = 0;
+    for (auto it = cache.begin(); it != cache.end();) {
+        const vector<int>& clientes = it->first;
+        bool temOrigem = origem == deposito || binary_search(clientes.begin(), clientes.end(), origem);
+        bool temDestino = destino == deposito || binary_search(clientes.begin(), clientes.end(), destino);
+        if (temOrigem && temDestino) {
+            it = cache.erase(it);
+            removidas++;
+        } else {
+            ++it;
+        }
+    }
+    return removidas;
+}
+
+// Aplica o delta sobre a instância do estado e invalida só as entradas afetadas do cache
+inline bool AplicarDelta(const string& caminho, EstadoResolvido& e) {
+    ifstream arquivo(caminho);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao abrir o delta: " << caminho << endl;
+        return false;
+    }
+    // as pontas das arestas alteradas ficam num conjunto para invalidar o cache uma única vez por aresta
+    set<pair<int, int>> alteradas;
+    int mudancas = 0;
+    string linha;
+    while (getline(arquivo, linha)) {
+        istringstream campos(linha);
+        string tipo;
+        if (!(campos >> tipo) || tipo[0] == '#') {
+            continue;
+        }
+        int a, b, valor;
+        if (tipo == "DEMANDA" && campos >> a >> valor) {
+            e.demanda[a] = valor;
+        } else if ((tipo == "ARESTA" && campos >> a >> b >> valor) || (tipo == "REMOVER" && campos >> a >> b)) {
+            e.arestas.erase(remove_if(e.arestas.begin(), e.arestas.end(), [&](const tuple<int, int, int>& aresta) {
+                return get<0>(aresta) == a && get<1>(aresta) == b;
+            }), e.arestas.end());
+            if (tipo == "ARESTA") {
+                e.arestas.push_back(make_tuple(a, b, valor));
+            }
+            alteradas.insert({a, b});
+        } else {
+            cerr << "Linha invalida no delta: " << linha << endl;
+            return false;
+        }
+        mudancas++;
+    }
+    int invalidadas = 0;
+    for (const auto& aresta : alteradas) {
+        invalidadas += InvalidarAresta(e.cache, aresta.first, aresta.second, e.deposito);
+    }
+    cout << "Delta: " << mudancas << " mudancas, " << invalidadas << " rotas invalidadas" << endl;
+    return true;
+}
+
+// Carrega o estado e aplica o delta. Os parâmetros da linha de comando têm prioridade sobre os do estado;
+// trocar o depósito muda o custo de todas as rotas, então nesse caso o cache inteiro é descartado.
+inline bool CarregarEstado(Opcoes& opcoes, EstadoResolvido& e) {
+    if (!LerEstado(opcoes.estado, e)) {
+        return false;
+    }
+    if (opcoes.deposito >= 0 && opcoes.deposito != e.deposito) {
+        e.cache.clear();
+    }
+    if (opcoes.deposito < 0) {
+        opcoes.deposito = e.deposito;
+    }
+    if (!opcoes.delta.empty() && !AplicarDelta(opcoes.delta, e)) {
+        return false;
+    }
+    if (opcoes.capacidade < 0) {
+        opcoes.capacidade = e.capacidade;
+    }
+    if (opcoes.frota < 0) {
+        opcoes.frota = e.frota;
+    }
+    cout << "Estado: " << e.cache.size() << " rotas com ordem reaproveitada" << endl;
+    return true;
+}
+
+// Custo da solução anterior com os dados atuais, ou INT_MAX se ela deixou de ser válida: alguma rota deixou de
+// ser candidata (capacidade estourada ou aresta removida, com o mesmo critério de GerarRotasCandidatas), a
+// solução não atende exatamente os clientes atuais ou a frota não comporta. Cada rota custa a sua melhor
+// ordem, pega do cache quando está lá.
+inline int CustoIncumbente(const vector<vector<int>>& solucao, const vector<int>& locais, map<int,int>& demanda, int capacidade,
+                           int frota, const MatrizCustos& m, int deposito, const CacheOrdens& cache) {
+    if (solucao.empty() || (frota > 0 && (int) solucao.size() > frota)) {
+        return INT_MAX;
+    }
+    set<int> atendidos;
+    size_t visitas = 0;
+    long long total = 0;
+    for (const auto& rota : solucao) {
+        vector<int> chave = rota;
+        sort(chave.begin(), chave.end());
+        int carga = 0;
+        for (size_t i = 0; i < chave.size(); i++) {
+            carga += demanda[chave[i]];
+            if (i > 0 && m(chave[i - 1], chave[i]) >= CUSTO_INFINITO) {
+                return INT_MAX;
+            }
+        }
+        if (carga > capacidade) {
+            return INT_MAX;
+        }
+        atendidos.insert(chave.begin(), chave.end());
+        visitas += chave.size();
+        auto it = cache.find(chave);
+        if (it != cache.end()) {
+            total += it->second.custo;
+        } else {
+            vector<int> ordem;
+            total += OrdenarRota(m, deposito, chave, ordem);
+        }
+    }
+    if (visitas != locais.size() || atendidos != set<int>(locais.begin(), locais.end())) {
+        return INT_MAX;
+    }
+    return total < INT_MAX ? (int) total : INT_MAX;
+}
+
+// Limite inicial da busca: o custo da solução anterior + 1, já que a busca só aceita soluções estritamente
+// melhores e precisa reencontrar uma solução ótima entre as rotas que sobraram da redução
+inline int LimiteInicial(const EstadoResolvido& e, const vector<int>& locais, map<int,int>& demanda, const Opcoes& opcoes,
+                         const MatrizCustos& m, bool imprimir) {
+    if (e.solucao.empty()) {
+        return INT_MAX;
+    }
+    int custo = CustoIncumbente(e.solucao, locais, demanda, opcoes.capacidade, opcoes.frota, m, opcoes.deposito, e.cache);
+    if (imprimir) {
+        if (custo < INT_MAX) {
+            cout << "Solucao anterior: " << custo << endl;
+        } else {
+            cout << "Solucao anterior deixou de ser valida" << endl;
+        }
+    }
+    return custo < INT_MAX ? custo + 1 : INT_MAX;
+}
+
+// Grava o estado desta execução (instância já com o delta, ordens calculadas e melhor solução)
+inline void SalvarExecucao(const Opcoes& opcoes, int numNos, const map<int,int>& demanda, const vector<tuple<int, int, int>>& arestas,
+                           const vector<vector<int>>& solucao, EstadoResolvido& e) {
+    e.capacidade = opcoes.capacidade;
+    e.frota = opcoes.frota;
+    e.deposito = opcoes.deposito;
+    e.numNos = numNos;
+    e.demanda = demanda;
+    e.arestas = arestas;
+    e.solucao = solucao;
+    SalvarEstado(opcoes.salvarEstado, e);
+}
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef INSTRUMENTACAO_H
+#define INSTRUMENTACAO_H
+
+// Contadores de busca e cronômetros de fase para os solvers de Global/.
+//
+// Só são compilados com -DVRP_INSTRUMENTACAO; sem a flag todas as macros INSTR_* viram nada e o código
+// gerado é o mesmo de antes. Cada thread escreve apenas no seu próprio bloco de contadores (alinhado em
+// 64 bytes para que duas threads nunca disputem a mesma linha de cache), então incrementar é só um
+// load/store relaxado, sem instrução atômica com lock. No final, os blocos são somados entre as threads
+// e, nos programas MPI, entre os ranks, e o resultado vai para um JSON.
+//
+// Variáveis de ambiente:
+//   VRP_INSTR_ARQUIVO   arquivo JSON final (padrão: instrumentacao.json)
+//   VRP_INSTR_INTERVALO segundos entre snapshots periódicos (padrão: 0, desligado); o snapshot vai para
+//                       <arquivo>.parcial (e <arquivo>.rank<r>.parcial nos programas MPI)
+
+#ifdef VRP_INSTRUMENTACAO
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace instr {
+
+enum Contador {
+    NOS,                     // nós (quadros da pilha / chamadas) visitados pela busca
+    PODAS,                   // nós descartados sem expandir
+    ATUALIZACOES_INCUMBENTE, // vezes em que a melhor solução foi melhorada
+    AVALIACOES_ROTA,         // cálculos de custo de rota durante a busca
+    COBERTURAS_TESTADAS,     // chamadas de cobreTodasCidades (ou teste equivalente)
+    COBERTURAS_OK,           // testes de cobertura que deram verdadeiro
+    TEMPO_BUSCA_NS,          // tempo que a thread passou dentro da busca
+    NUM_CONTADORES
+};
+
+enum Fase {
+    LEITURA,
+    GERACAO,
+    BUSCA,
+    REDUCAO,
+    NUM_FASES
+};
+
+inline const char* nomesContadores[NUM_CONTADORES] = {
+    "nos", "podas", "atualizacoes_incumbente", "avaliacoes_rota", "coberturas_testadas", "coberturas_ok", "tempo_busca_ns"
+};
+inline const char* nomesFases[NUM_FASES] = {"leitura", "geracao", "busca", "reducao"};
+
+constexpr int MAX_THREADS = 256;
+// a cada 2^20 nós uma thread confere se já passou o intervalo do snapshot periódico
+constexpr uint64_t MASCARA_VERIFICACAO = (1u << 20) - 1;
+
+struct alignas(64) ContadoresThread {
+    std::atomic<uint64_t> valor[NUM_CONTADORES];
+
+    // só a thread dona escreve, então não precisa de fetch_add
+    void soma(Contador c, uint64_t quantidade = 1) {
+        valor[c].store(valor[c].load(std::memory_order_relaxed) + quantidade, std::memory_order_relaxed);
+    }
+};
+
+struct Estado {
+    ContadoresThread threads[MAX_THREADS] = {};
+    std::atomic<int> threadsUsadas{1};
+    double fases[NUM_FASES] = {};
+    int rank = 0;
+    int ranks = 1;
+    double intervalo = 0.0;
+    std::string arquivo = "instrumentacao.json";
+    std::atomic<int64_t> ultimoSnapshotNs{0};
+    std::atomic<bool> escrevendoSnapshot{false};
+
+    Estado() {
+        if (const char* a = std::getenv("VRP_INSTR_ARQUIVO")) {
+            arquivo = a;
+        }
+        if (const char* i = std::getenv("VRP_INSTR_INTERVALO")) {
+            intervalo = std::atof(i);
+        }
+        ultimoSnapshotNs = agoraNs();
+    }
+
+    static int64_t agoraNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+inline Estado estado;
+
+inline ContadoresThread& local() {
+#ifdef _OPENMP
+    int t = omp_get_thread_num();
+    if (t >= MAX_THREADS) {
+        t = MAX_THREADS - 1;
+    }
+    int usadas = estado.threadsUsadas.load(std::memory_order_relaxed);
+    while (t + 1 > usadas && !estado.threadsUsadas.compare_exchange_weak(usadas, t + 1)) {
+    }
+    return estado.threads[t];
+#else
+    return estado.threads[0];
+#endif
+}
+
+inline uint64_t total(Contador c) {
+    uint64_t soma = 0;
+    for (int t = 0; t < estado.threadsUsadas.load(); t++) {
+        soma += estado.threads[t].valor[c].load(std::memory_order_relaxed);
+    }
+    return soma;
+}
+
+// Escreve o JSON com os contadores desta execução. "porRank" (opcional) traz os totais de cada rank,
+// já reunidos no rank 0, no formato [rank][contador].
+inline void escreverJson(const std::string& caminho, const uint64_t* porRank = nullptr, const double* fasesMax = nullptr) {
+    std::ofstream saida(caminho);
+    if (!saida.is_open()) {
+        std::cerr << "Erro ao abrir o arquivo de instrumentação: " << caminho << std::endl;
+        return;
+    }
+    int threads = estado.threadsUsadas.load();
+    saida << "{\n  \"ranks\": " << estado.ranks << ",\n  \"threads\": " << threads << ",\n  \"fases_s\": {";
+    for (int f = 0; f < NUM_FASES; f++) {
+        saida << (f ? ", " : "") << "\"" << nomesFases[f] << "\": " << (fasesMax ? fasesMax[f] : estado.fases[f]);
+    }
+    saida << "},\n  \"total\": {";
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        uint64_t soma = 0;
+        if (porRank) {
+            for (int r = 0; r < estado.ranks; r++) {
+                soma += porRank[r * NUM_CONTADORES + c];
+            }
+        } else {
+            soma = total((Contador) c);
+        }
+        saida << (c ? ", " : "") << "\"" << nomesContadores[c] << "\": " << soma;
+    }
+    saida << "}";
+    if (!porRank) {
+        saida << ",\n  \"por_thread\": [";
+        for (int t = 0; t < threads; t++) {
+            saida << (t ? ",\n    " : "\n    ") << "{";
+            for (int c = 0; c < NUM_CONTADORES; c++) {
+                saida << (c ? ", " : "") << "\"" << nomesContadores[c] << "\": " << estado.threads[t].valor[c].load(std::memory_order_relaxed);
+            }
+            saida << "}";
+        }
+        saida << "\n  ]";
+    } else {
+        saida << ",\n  \"por_rank\": [";
+        for (int r = 0; r < estado.ranks; r++) {
+            saida << (r ? ",\n    " : "\n    ") << "{";
+            for (int c = 0; c < NUM_CONTADORES; c++) {
+                saida << (c ? ", " : "") << "\"" << nomesContadores[c] << "\": " << porRank[r * NUM_CONTADORES + c];
+            }
+            saida << "}";
+        }
+        saida << "\n  ]";
+    }
+    saida << "\n}\n";
+}
+
+// Chamado a cada nó: conta e, de vez em quando, confere se está na hora do snapshot periódico.
+// Só uma thread por vez escreve o snapshot; as outras seguem a busca.
+inline void no(ContadoresThread& ct) {
+    uint64_t n = ct.valor[NOS].load(std::memory_order_relaxed) + 1;
+    ct.valor[NOS].store(n, std::memory_order_relaxed);
+    if ((n & MASCARA_VERIFICACAO) != 0 || estado.intervalo <= 0.0) {
+        return;
+    }
+    int64_t agora = Estado::agoraNs();
+    if ((agora - estado.ultimoSnapshotNs.load(std::memory_order_relaxed)) * 1e-9 < estado.intervalo) {
+        return;
+    }
+    if (estado.escrevendoSnapshot.exchange(true)) {
+        return;
+    }
+    estado.ultimoSnapshotNs.store(agora, std::memory_order_relaxed);
+    std::string caminho = estado.arquivo;
+    if (estado.ranks > 1) {
+        caminho += ".rank" + std::to_string(estado.rank);
+    }
+    escreverJson(caminho + ".parcial");
+    estado.escrevendoSnapshot.store(false);
+}
+
+// Mede o tempo entre a construção e a destruição e soma em TEMPO_BUSCA_NS da thread
+struct CronometroThread {
+    ContadoresThread& ct;
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+    explicit CronometroThread(ContadoresThread& c) : ct(c) {}
+    ~CronometroThread() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - inicio).count();
+        ct.soma(TEMPO_BUSCA_NS, (uint64_t) ns);
+    }
+};
+
+// Mede uma fase do programa principal (leitura, geração, busca, redução)
+struct CronometroFase {
+    Fase fase;
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+    explicit CronometroFase(Fase f) : fase(f) {}
+    void parar() {
+        estado.fases[fase] += std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        inicio = std::chrono::steady_clock::now();
+    }
+};
+
+#ifdef MPI_VERSION
+// Reúne os contadores de todos os ranks no rank 0 (os tempos de fase ficam com o maior entre os ranks,
+// que é o que determina o tempo total) e escreve o JSON final.
+inline void finalizarMPI(int rank, int ranks) {
+    estado.rank = rank;
+    estado.ranks = ranks;
+    uint64_t meus[NUM_CONTADORES];
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        meus[c] = total((Contador) c);
+    }
+    uint64_t* todos = rank == 0 ? new uint64_t[(size_t) ranks * NUM_CONTADORES] : nullptr;
+    double fasesMax[NUM_FASES];
+    MPI_Gather(meus, NUM_CONTADORES, MPI_UINT64_T, todos, NUM_CONTADORES, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    MPI_Reduce(estado.fases, fasesMax, NUM_FASES, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        escreverJson(estado.arquivo, todos, fasesMax);
+        uint64_t nos = 0;
+        for (int r = 0; r < ranks; r++) {
+            nos += todos[r * NUM_CONTADORES + NOS];
+        }
+        std::cout << "Nos explorados: " << nos << std::endl;
+        delete[] todos;
+    }
+}
+#endif
+
+inline void finalizar() {
+    escreverJson(estado.arquivo);
+    std::cout << "Nos explorados: " << total(NOS) << std::endl;
+}
+
+} // namespace instr
+
+#define INSTR_LOCAL(nome) instr::ContadoresThread& nome = instr::local()
+#define INSTR_CONTA(ct, contador) (ct).soma(instr::contador)
+#define INSTR_NO(ct) instr::no(ct)
+#define INSTR_CRONOMETRO_THREAD(ct) instr::CronometroThread instrCronometroThread(ct)
+#define INSTR_FASE(nome, fase) instr::CronometroFase nome(instr::fase)
+#define INSTR_FASE_FIM(nome) (nome).parar()
+#define INSTR_MPI_INIT(r, n) (instr::estado.rank = (r), instr::estado.ranks = (n))
+#define INSTR_FINALIZAR() instr::finalizar()
+#define INSTR_FINALIZAR_MPI(r, n) instr::finalizarMPI(r, n)
+
+#else
+
+#define INSTR_LOCAL(nome)
+#define INSTR_CONTA(ct, contador)
+#define INSTR_NO(ct)
+#define INSTR_CRONOMETRO_THREAD(ct)
+#define INSTR_FASE(nome, fase)
+#define INSTR_FASE_FIM(nome)
+#define INSTR_MPI_INIT(rank, ranks)
+#define INSTR_FINALIZAR()
+#define INSTR_FINALIZAR_MPI(rank, ranks)
+
+#endif
+
+#endif
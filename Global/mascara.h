@@ -0,0 +1,65 @@
+#ifndef MASCARA_H
+#define MASCARA_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+// Tipos de máscara de clientes usados para especializar a busca pelo tamanho da instância: o solver
+// escolhe em tempo de execução o menor tipo em que cabem todos os clientes (ver DespacharPorTamanho),
+// o que deixa os quadros da pilha e os registros das rotas menores e mais rotas por linha de cache.
+
+typedef unsigned __int128 uint128_t;
+
+template <typename Mascara>
+constexpr int BitsMascara() {
+    return (int) sizeof(Mascara) * 8;
+}
+
+inline int MenorBit(uint16_t m) { return __builtin_ctz(m); }
+inline int MenorBit(uint32_t m) { return __builtin_ctz(m); }
+inline int MenorBit(uint64_t m) { return __builtin_ctzll(m); }
+inline int MenorBit(uint128_t m) {
+    uint64_t baixo = (uint64_t) m;
+    return baixo ? __builtin_ctzll(baixo) : 64 + __builtin_ctzll((uint64_t) (m >> 64));
+}
+
+inline int ContarBits(uint16_t m) { return __builtin_popcount(m); }
+inline int ContarBits(uint32_t m) { return __builtin_popcount(m); }
+inline int ContarBits(uint64_t m) { return __builtin_popcountll(m); }
+inline int ContarBits(uint128_t m) { return __builtin_popcountll((uint64_t) m) + __builtin_popcountll((uint64_t) (m >> 64)); }
+
+// Máscara com os n primeiros clientes (n pode ser igual ao número de bits do tipo)
+template <typename Mascara>
+Mascara MascaraTodos(int n) {
+    return n >= BitsMascara<Mascara>() ? (Mascara) ~Mascara(0) : (Mascara) ((Mascara(1) << n) - 1);
+}
+
+// std::hash não tem especialização para __int128
+struct HashMascara {
+    size_t operator()(uint128_t m) const {
+        uint64_t x = (uint64_t) m ^ ((uint64_t) (m >> 64) * 0x9e3779b97f4a7c15ULL);
+        return std::hash<uint64_t>()(x);
+    }
+};
+
+// Chama funcao(Mascara()) com o menor tipo de máscara em que cabem n clientes; com uma lambda genérica
+// [&](auto zero) { using Mascara = decltype(zero); ... } o corpo é compilado uma vez para cada tipo.
+// Devolve false se a instância tem clientes demais para qualquer especialização.
+template <typename Funcao>
+bool DespacharPorTamanho(int n, Funcao&& funcao) {
+    if (n <= 16) {
+        funcao(uint16_t());
+    } else if (n <= 32) {
+        funcao(uint32_t());
+    } else if (n <= 64) {
+        funcao(uint64_t());
+    } else if (n <= 128) {
+        funcao(uint128_t());
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif
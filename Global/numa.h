@@ -0,0 +1,207 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <sched.h>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "buscaIterativa.h"
+
+using namespace std;
+
+// Posicionamento das threads do solver OpenMP em máquinas com mais de um soquete (NUMA).
+//
+// Sem nada disso o runtime coloca as threads onde quiser e a tabela de rotas compactas, as tarefas e o índice
+// dos grupos ficam na memória do nó em que a thread principal os montou, então metade das threads lê tudo
+// pela interconexão entre soquetes. Com --afinidade compacta|espalhada (ou OMP_PROC_BIND):
+//  - cada thread é fixada numa CPU: "compacta" enche um nó antes de passar ao seguinte, "espalhada" alterna
+//    os nós (thread t no nó t % nós);
+//  - cada nó recebe a sua cópia das estruturas só de leitura da busca, construída pela primeira thread do nó
+//    que chega, de modo que as páginas são alocadas na memória local (first touch);
+//  - as tarefas são repartidas em uma fila por nó e cada thread consome primeiro a fila do seu nó; só quando
+//    ela acaba passa a roubar das filas dos outros nós.
+// Com um único nó (ou sem fixar as threads, quando o nó de cada thread pode mudar) fica uma única fila e
+// nenhuma cópia, o que equivale ao schedule(dynamic) de antes.
+// A topologia vem de /sys/devices/system/node, restrita às CPUs permitidas ao processo (cgroups do SLURM).
+// VRP_NUMA_SIMULAR=k divide as CPUs em k nós fictícios, para exercitar o código numa máquina de um nó só.
+
+// Lista no formato do kernel ("0-3,8,10-11")
+inline vector<int> LerListaCpus(const string& texto) {
+    vector<int> cpus;
+    stringstream campos(texto);
+    string parte;
+    while (getline(campos, parte, ',')) {
+        if (parte.empty()) {
+            continue;
+        }
+        size_t traco = parte.find('-');
+        int inicio = stoi(parte.substr(0, traco));
+        int fim = traco == string::npos ? inicio : stoi(parte.substr(traco + 1));
+        for (int c = inicio; c <= fim; c++) {
+            cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+struct TopologiaNuma {
+    vector<vector<int>> cpus; // CPUs permitidas de cada nó (só nós com alguma CPU)
+    string afinidade;         // "" = threads não são fixadas pelo solver
+    bool fixada = false;      // as threads ficam sempre no mesmo nó (pelo solver ou por OMP_PROC_BIND)
+
+    int nos() const {
+        return fixada ? (int) cpus.size() : 1;
+    }
+
+    // Fixa a thread (se pedido) e devolve o índice do nó em que ela roda
+    int fixarThread(int thread) const {
+        if (!fixada) {
+            return 0;
+        }
+        if (!afinidade.empty()) {
+            int no, cpu;
+            if (afinidade == "espalhada") {
+                no = thread % cpus.size();
+                cpu = cpus[no][(thread / cpus.size()) % cpus[no].size()];
+            } else {
+                int total = 0;
+                for (const auto& c : cpus) {
+                    total += c.size();
+                }
+                int posicao = thread % total;
+                for (no = 0; posicao >= (int) cpus[no].size(); no++) {
+                    posicao -= cpus[no].size();
+                }
+                cpu = cpus[no][posicao];
+            }
+            cpu_set_t conjunto;
+            CPU_ZERO(&conjunto);
+            CPU_SET(cpu, &conjunto);
+            sched_setaffinity(0, sizeof(conjunto), &conjunto);
+            return no;
+        }
+        // fixada pelo runtime: o nó é o da CPU atual
+        int atual = sched_getcpu();
+        for (int no = 0; no < (int) cpus.size(); no++) {
+            for (int cpu : cpus[no]) {
+                if (cpu == atual) {
+                    return no;
+                }
+            }
+        }
+        return 0;
+    }
+};
+
+inline TopologiaNuma LerTopologiaNuma(const string& afinidade) {
+    TopologiaNuma t;
+    t.afinidade = afinidade;
+    t.fixada = !afinidade.empty() || omp_get_proc_bind() != omp_proc_bind_false;
+    cpu_set_t permitidas;
+    CPU_ZERO(&permitidas);
+    sched_getaffinity(0, sizeof(permitidas), &permitidas);
+    vector<int> todas;
+    for (int no = 0;; no++) {
+        ifstream lista("/sys/devices/system/node/node" + to_string(no) + "/cpulist");
+        if (!lista.is_open()) {
+            break;
+        }
+        string texto;
+        getline(lista, texto);
+        vector<int> cpus;
+        for (int cpu : LerListaCpus(texto)) {
+            if (CPU_ISSET(cpu, &permitidas)) {
+                cpus.push_back(cpu);
+                todas.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            t.cpus.push_back(cpus);
+        }
+    }
+    if (t.cpus.empty()) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &permitidas)) {
+                todas.push_back(cpu);
+            }
+        }
+        t.cpus.push_back(todas);
+    }
+    if (const char* simular = getenv("VRP_NUMA_SIMULAR")) {
+        int k = max(1, atoi(simular));
+        t.cpus.assign(k, {});
+        for (int i = 0; i < max(k, (int) todas.size()); i++) {
+            t.cpus[i % k].push_back(todas[i % todas.size()]);
+        }
+    }
+    return t;
+}
+
+// Cópia das estruturas só de leitura da busca para um nó
+template <typename Mascara>
+struct ReplicaNuma {
+    vector<RotaCompacta<Mascara>> rotas;
+    IndiceRotas<Mascara> indice;
+    ListaTarefas<Mascara> tarefas;
+};
+
+// Réplica do nó, criada pela primeira thread do nó que pede (a cópia é feita por ela, então as páginas ficam
+// na memória do nó). Com um nó só não há cópia: devolve nullptr e a busca usa as estruturas originais.
+template <typename Mascara>
+const ReplicaNuma<Mascara>* ReplicaDoNo(vector<unique_ptr<ReplicaNuma<Mascara>>>& replicas, int no,
+                                        TabelaRotas<Mascara> rotas, const IndiceRotas<Mascara>& indice,
+                                        const ListaTarefas<Mascara>& tarefas) {
+    if (replicas.size() <= 1) {
+        return nullptr;
+    }
+    #pragma omp critical(replicaNuma)
+    {
+        if (!replicas[no]) {
+            replicas[no].reset(new ReplicaNuma<Mascara>{{rotas.begin(), rotas.end()}, indice, tarefas});
+        }
+    }
+    return replicas[no].get();
+}
+
+// Uma fila de tarefas por nó. O contador de cada fila fica na sua própria linha de cache.
+struct FilasNuma {
+    struct alignas(64) Fila {
+        atomic<int> proxima{0};
+        int tamanho = 0;
+    };
+    unique_ptr<Fila[]> filas;
+    int nos;
+
+    // os itens 0..total-1 são distribuídos alternadamente entre os nós, para cada fila ter tarefas de todos
+    // os tamanhos: a fila k tem os itens k, k + nos, k + 2 * nos, ..., então nenhuma guarda a lista
+    FilasNuma(int numNos, int total) : filas(new Fila[numNos]), nos(numNos) {
+        for (int k = 0; k < nos; k++) {
+            filas[k].tamanho = (total - k + nos - 1) / nos;
+        }
+    }
+
+    // Próximo item para uma thread do nó "no": da fila dele e, quando ela acaba, das dos outros nós.
+    // Devolve -1 quando todas acabaram.
+    int proxima(int no) {
+        for (int k = 0; k < nos; k++) {
+            int fila = (no + k) % nos;
+            Fila& f = filas[fila];
+            if (f.proxima.load(memory_order_relaxed) >= f.tamanho) {
+                continue;
+            }
+            int i = f.proxima.fetch_add(1, memory_order_relaxed);
+            if (i < f.tamanho) {
+                return fila + i * nos;
+            }
+        }
+        return -1;
+    }
+};
+
+#endif
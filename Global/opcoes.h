@@ -0,0 +1,176 @@
+#ifndef OPCOES_H
+#define OPCOES_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Parâmetros da instância que antes eram fixos no código (capacidade 10, depósito 0, frota ilimitada).
+// Podem vir da linha de comando:
+//   <arquivo> [--capacidade C] [--frota K] [--deposito D]
+// ou de linhas opcionais "CHAVE valor" depois das arestas do arquivo (CAPACIDADE, FROTA, DEPOSITO, como as
+// que o gerador escreve). A linha de comando tem prioridade sobre o arquivo.
+// Para a reotimização incremental (incremental.h) a instância pode vir de um estado salvo no lugar do arquivo:
+//   --estado E [--delta D] [--salvar-estado S]
+// e a busca pode gravar pontos de controle para continuar depois (checkpoint.h):
+//   --checkpoint P [--intervalo-checkpoint S] [--resume]
+// e consultar e alimentar um cache de instâncias já resolvidas (cacheInstancias.h):
+//   --cache D
+// No solver OpenMP, as threads podem ser fixadas nos nós NUMA (numa.h):
+//   --afinidade compacta|espalhada
+// e, só na partição (ver abaixo), gravar as rotas candidatas numa tabela em disco em vez de guardá-las na
+// memória (rotasDisco.h):
+//   --rotas-disco ARQ [--memoria-rotas MB]
+// A busca exata aceita por padrão que um cliente apareça em mais de uma rota (cobertura, como a versão
+// original); com --particao cada cliente fica em exatamente uma rota (ver buscaIterativa.h):
+//   --particao
+// Só na partição, a busca exata pode partir do limite da relaxação linear (relaxacao.h):
+//   --relaxacao
+
+struct Opcoes {
+    string arquivo;
+    int capacidade = -1; // -1 = não informado
+    int frota = -1;      // 0 = ilimitada
+    int deposito = -1;
+    string estado;       // estado de uma execução anterior (substitui o arquivo da instância)
+    string delta;        // mudanças a aplicar sobre o estado
+    string salvarEstado; // onde gravar o estado desta execução
+    string checkpoint;   // prefixo dos arquivos de checkpoint (vazio = desligado)
+    double intervaloCheckpoint = 60.0;
+    bool retomar = false;
+    string cache;        // diretório do cache de soluções (vazio = desligado)
+    string afinidade;    // "" = o runtime decide onde ficam as threads
+    string rotasDisco;   // arquivo da tabela de rotas em disco (vazio = rotas na memória)
+    int memoriaRotas = 256; // MB usados para ordenar a tabela em disco
+    bool relaxacao = false; // custos reduzidos do LP na busca
+    bool particao = false;  // cada cliente em exatamente uma rota (sem a opção, cobertura)
+};
+
+inline void ImprimirUso(const char* programa) {
+    cout << "Usage: " << programa << " <file> [--capacidade C] [--frota K] [--deposito D] [--salvar-estado S]" << endl;
+    cout << "       " << programa << " --estado E [--delta D] [--salvar-estado S] [--capacidade C] [--frota K] [--deposito D]" << endl;
+    cout << "       (qualquer um dos dois) [--checkpoint P] [--intervalo-checkpoint S] [--resume] [--cache D] [--particao] [--relaxacao]" << endl;
+    cout << "       (OpenMP) [--afinidade compacta|espalhada] [--rotas-disco ARQ] [--memoria-rotas MB]" << endl;
+}
+
+inline bool LerOpcoes(int argc, char* argv[], Opcoes& op) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            if (!op.arquivo.empty()) {
+                return false;
+            }
+            op.arquivo = arg;
+            continue;
+        }
+        if (arg == "--resume") {
+            op.retomar = true;
+            continue;
+        }
+        if (arg == "--relaxacao") {
+            op.relaxacao = true;
+            continue;
+        }
+        if (arg == "--particao") {
+            op.particao = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string valor = argv[++i];
+        if (arg == "--capacidade") {
+            op.capacidade = stoi(valor);
+        } else if (arg == "--frota") {
+            op.frota = stoi(valor);
+        } else if (arg == "--deposito") {
+            op.deposito = stoi(valor);
+        } else if (arg == "--estado") {
+            op.estado = valor;
+        } else if (arg == "--delta") {
+            op.delta = valor;
+        } else if (arg == "--salvar-estado") {
+            op.salvarEstado = valor;
+        } else if (arg == "--checkpoint") {
+            op.checkpoint = valor;
+        } else if (arg == "--intervalo-checkpoint") {
+            op.intervaloCheckpoint = stod(valor);
+        } else if (arg == "--cache") {
+            op.cache = valor;
+        } else if (arg == "--afinidade" && (valor == "compacta" || valor == "espalhada")) {
+            op.afinidade = valor;
+        } else if (arg == "--rotas-disco") {
+            op.rotasDisco = valor;
+        } else if (arg == "--memoria-rotas") {
+            op.memoriaRotas = stoi(valor);
+        } else {
+            return false;
+        }
+    }
+    // o delta só faz sentido sobre um estado, e o estado já traz a instância
+    if (!op.delta.empty() && op.estado.empty()) {
+        return false;
+    }
+    if (op.retomar && op.checkpoint.empty()) {
+        return false;
+    }
+    return op.arquivo.empty() != op.estado.empty();
+}
+
+// Os custos reduzidos da relaxação só preservam a ordem entre partições, e a tabela em disco não tem como
+// marcar as rotas que podem sobrepor (isso precisa de todas as máscaras na memória): as duas pedem --particao.
+// Devolve a mensagem de erro, ou "" se as opções são compatíveis.
+inline string ConferirParticao(const Opcoes& op) {
+    if (op.particao) {
+        return "";
+    }
+    if (op.relaxacao) {
+        return "--relaxacao so vale para a particao: use junto com --particao";
+    }
+    if (!op.rotasDisco.empty()) {
+        return "--rotas-disco so vale para a particao: use junto com --particao";
+    }
+    return "";
+}
+
+// Lê as linhas "CHAVE valor" que vêm depois das arestas; só preenche o que a linha de comando não informou
+inline void LerParametrosArquivo(istream& arquivo, Opcoes& op) {
+    string chave;
+    int valor;
+    while (arquivo >> chave >> valor) {
+        if (chave == "CAPACIDADE" && op.capacidade < 0) {
+            op.capacidade = valor;
+        } else if (chave == "FROTA" && op.frota < 0) {
+            op.frota = valor;
+        } else if (chave == "DEPOSITO" && op.deposito < 0) {
+            op.deposito = valor;
+        }
+    }
+}
+
+inline void AplicarPadroes(Opcoes& op, int capacidadePadrao) {
+    if (op.capacidade < 0) {
+        op.capacidade = capacidadePadrao;
+    }
+    if (op.frota < 0) {
+        op.frota = 0;
+    }
+    if (op.deposito < 0) {
+        op.deposito = 0;
+    }
+}
+
+// Clientes = todos os nós 0..numNos-1 menos o depósito
+inline vector<int> ClientesSemDeposito(int numNos, int deposito) {
+    vector<int> locais;
+    for (int i = 0; i < numNos; i++) {
+        if (i != deposito) {
+            locais.push_back(i);
+        }
+    }
+    return locais;
+}
+
+#endif
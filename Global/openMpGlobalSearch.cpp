@@ -7,246 +7,333 @@
 #include <climits>
 #include <set>
 #include <chrono>
-#include <stack>
-#include <unordered_map>
+#include <memory>
 #include <omp.h>
+#include "instrumentacao.h"
+#include "buscaIterativa.h"
+#include "candidatos.h"
+#include "opcoes.h"
+#include "incremental.h"
+#include "checkpoint.h"
+#include "cacheInstancias.h"
+#include "numa.h"
+#include "rotasDisco.h"
+#include "relaxacao.h"
 
 using namespace std;
 
-class Grafo {
-    unordered_map<int, vector<pair<int, int>>> grafo_classe;
+void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes);
 
-public:
-    // Função para adicionar uma aresta ao grafo
-    void adicionarAresta(int origem, int destino, int peso) {
-        grafo_classe[origem].push_back(make_pair(destino, peso));
+// Redução das rotas e busca paralela com clientes representados em máscaras do tipo Mascara.
+// Devolve 0 se a busca terminou, 1 em caso de erro no checkpoint e 2 se ela foi interrompida por um sinal
+// (com o checkpoint gravado).
+template <typename Mascara>
+int BuscarMelhorCombinacao(vector<vector<int>>& rotas, const vector<int>& locais, map<int,int>& demanda, const MatrizCustos& matriz,
+                           int deposito, int frota, CacheOrdens* cache, const Opcoes& opcoes, int& melhorCusto, vector<int>& melhorCaminho,
+                           LimiteLP& relaxacao) {
+    vector<RotaCompacta<Mascara>> compactas;
+    RotasEmDisco<Mascara> disco;
+    TabelaRotas<Mascara> tabela;
+    if (opcoes.rotasDisco.empty()) {
+        // remove rotas dominadas e coloca cada rota na sua melhor ordem antes da busca
+        INSTR_FASE(faseReducaoRotas, GERACAO);
+        ReduzirCandidatos<Mascara>(rotas, locais, matriz, deposito, frota > 0, cache);
+        INSTR_FASE_FIM(faseReducaoRotas);
+        cout << "Rotas apos reducao: " << rotas.size() << endl;
+        compactas = CompactarRotas<Mascara>(rotas, locais, demanda, matriz, deposito);
+        // limite do LP: a busca passa a usar os custos reduzidos (e melhorCusto fica na mesma escala)
+        if (opcoes.relaxacao) {
+            relaxacao = AplicarRelaxacao(rotas, compactas, locais.size(), frota, melhorCusto, true);
+        }
+        tabela = compactas;
+    } else {
+        if (opcoes.relaxacao) {
+            cout << "--relaxacao precisa da tabela de rotas na memoria (sem --rotas-disco)" << endl;
+            return 1;
+        }
+        // as rotas vão do gerador direto para o arquivo, já na melhor ordem e sem a redução por dominância
+        INSTR_FASE(faseGeracaoDisco, GERACAO);
+        long long gravadas;
+        bool gravou = GravarRotasDisco<Mascara>(opcoes.rotasDisco, locais, demanda, opcoes.capacidade, matriz, deposito,
+                                                (size_t) opcoes.memoriaRotas << 20, gravadas);
+        INSTR_FASE_FIM(faseGeracaoDisco);
+        if (!gravou || !disco.abrir(opcoes.rotasDisco, locais.size())) {
+            cout << "Erro ao gravar a tabela de rotas em " << opcoes.rotasDisco << endl;
+            return 1;
+        }
+        cout << "Rotas: " << gravadas << " (em disco)" << endl;
+        tabela = disco.tabela();
     }
+    Mascara todas = MascaraTodos<Mascara>(locais.size());
+    IndiceRotas<Mascara> indice = IndexarRotas(tabela, locais.size(), opcoes.particao);
+    // ao retomar, as tarefas precisam ser as mesmas da execução que gravou o checkpoint, mesmo com outro número de threads
+    bool usarCheckpoint = !opcoes.checkpoint.empty();
+    int minimoTarefas = 4 * omp_get_max_threads();
+    if (opcoes.retomar) {
+        minimoTarefas = MinimoTarefasSalvo(opcoes.checkpoint, ".t", minimoTarefas);
+    }
+    ListaTarefas<Mascara> tarefas = GerarTarefas(tabela, indice, todas, frota, minimoTarefas);
 
-    // função para calcular custo de uma rota
-    int calcularCustoRota(const vector<int>& rota) {
-        // copia de rota
-        vector<int> rota_copia = rota;
-        rota_copia.push_back(0);
-        rota_copia.insert(rota_copia.begin(), 0);
-        int custo = 0;
-        for (int i = 0; i < rota_copia.size() - 1; i++) {
-            int origem = rota_copia[i];
-            int destino = rota_copia[i + 1];
-
-            for (const auto& aresta : grafo_classe[origem]) {
-                if (aresta.first == destino) {
-                    custo += aresta.second;
-                    break;
-                }
+    Retomada<Mascara> retomada;
+    CabecalhoCheckpoint cabecalho;
+    if (usarCheckpoint) {
+        cabecalho = CabecalhoEsperado(tabela, indice, tarefas, minimoTarefas);
+        if (opcoes.retomar) {
+            vector<string> lidos;
+            if (!CarregarRetomada(opcoes.checkpoint, ".t", cabecalho, retomada, lidos) || !ConsolidarRetomada(opcoes.checkpoint, retomada, lidos)) {
+                return 1;
             }
+            cout << "Checkpoint: " << retomada.concluida.quantidade() << " tarefas concluidas, "
+                 << retomada.parciais.size() << " interrompidas, " << retomada.nos << " nos ja explorados" << endl;
+            if (retomada.melhorCusto < melhorCusto) {
+                melhorCusto = retomada.melhorCusto;
+                melhorCaminho = retomada.melhorCaminho;
+            }
+        } else {
+            RemoverCheckpoint(opcoes.checkpoint, ".t");
         }
-
-        return custo;
+        InstalarSinalParada();
     }
+    // tarefas, pendentes, filas e concluídas não guardam nada por tarefa, já que com a tabela em disco há uma
+    // tarefa por rota do grupo do cliente 0
+    TarefasPendentes<Mascara> pendentes(retomada, tarefas.size());
+    int totalTarefas = pendentes.size();
+    ProgressoComum progresso;
 
-    // Função para verificar se uma rota é válida
-    bool verificarRotaValida(const vector<int>& rota) {
-        for (int i = 0; i < rota.size() - 1; i++) {
-            int origem = rota[i];
-            int destino = rota[i + 1];
+    // com as threads fixadas, cada nó NUMA tem a sua cópia das rotas e a sua fila de tarefas (a tabela em
+    // disco não é copiada: ela fica no cache de páginas do sistema)
+    TopologiaNuma topologia = LerTopologiaNuma(opcoes.afinidade);
+    vector<unique_ptr<ReplicaNuma<Mascara>>> replicas(opcoes.rotasDisco.empty() ? topologia.nos() : 1);
+    FilasNuma filas(topologia.nos(), totalTarefas);
+    if (topologia.nos() > 1) {
+        cout << "NUMA: " << topologia.nos() << " nos" << endl;
+    }
 
-            // Verifica se há uma aresta entre os vértices da rota
-            if (grafo_classe.find(origem) == grafo_classe.end()) {
-                return false;
+    INSTR_FASE(faseBusca, BUSCA);
+    // Paralelizando a busca pela melhor combinação, começando por adicionar o bloco de pragma omp parallel, para que as threads tenham acesso ao trecho de código
+    #pragma omp parallel
+    {
+        int no = topologia.fixarThread(omp_get_thread_num());
+        const ReplicaNuma<Mascara>* replica = ReplicaDoNo(replicas, no, tabela, indice, tarefas);
+        TabelaRotas<Mascara> rotasNo = replica ? TabelaRotas<Mascara>(replica->rotas) : tabela;
+        const IndiceRotas<Mascara>& indiceNo = replica ? replica->indice : indice;
+        const ListaTarefas<Mascara>& tarefasNo = replica ? replica->tarefas : tarefas;
+        // pilha e caminho alocados uma única vez por thread e reaproveitados em todas as iterações
+        unique_ptr<EspacoBusca<Mascara>> espaco(new EspacoBusca<Mascara>);
+        // cada thread grava o seu próprio arquivo de checkpoint
+        unique_ptr<PontoControle<Mascara>> pc;
+        if (usarCheckpoint) {
+            pc.reset(new PontoControle<Mascara>(opcoes.checkpoint + ".t" + to_string(omp_get_thread_num()), cabecalho, opcoes.intervaloCheckpoint,
+                                                &progresso));
+        }
+        vector<int> caminhoTarefa;
+        caminhoTarefa.reserve(locais.size());
+        vector<int> melhorCaminhoLocal;
+        int melhorCustoLocal = INT_MAX;
+        // As tarefas são distribuídas dinamicamente (como num schedule(dynamic)) pois o tempo de verificação das rotas pode ser bem diferente,
+        // primeiro da fila do nó NUMA da thread e depois das filas dos outros nós.
+        // Cada iteração cuida das combinações que começam pelo prefixo da tarefa i, então nenhuma combinação é visitada duas vezes
+        for (int i = filas.proxima(no); i >= 0; i = filas.proxima(no)) {
+            // depois de um sinal as tarefas que faltam ficam para o --resume
+            if (pararSolicitado) {
+                break;
             }
-
-            bool arestaEncontrada = false;
-            for (const auto& aresta : grafo_classe[origem]) {
-                if (aresta.first == destino) {
-                    arestaEncontrada = true;
-                    break;
+            // o melhor custo já encontrado por qualquer thread serve de limite para podar esta tarefa
+            int custoTarefa;
+            #pragma omp atomic read
+            custoTarefa = melhorCusto;
+            custoTarefa = min(custoTarefa, melhorCustoLocal);
+            caminhoTarefa.clear();
+            ExecutarTarefa(rotasNo, indiceNo, tarefasNo, todas, frota, retomada, pendentes[i], *espaco, custoTarefa, caminhoTarefa, pc.get());
+            if (!caminhoTarefa.empty()) {
+                melhorCustoLocal = custoTarefa;
+                melhorCaminhoLocal = caminhoTarefa;
+                // Adicionamos a região critica para garantir que apenas uma thread tenha acesso ao recurso compartilhado
+                #pragma omp critical
+                {
+                    if (melhorCustoLocal < melhorCusto) {
+                        // as outras threads leem melhorCusto com atomic read, fora da região crítica
+                        #pragma omp atomic write
+                        melhorCusto = melhorCustoLocal;
+                        melhorCaminho = melhorCaminhoLocal;
+                    }
                 }
             }
-
-            if (!arestaEncontrada) {
-                return false;
-            }
         }
-
-        return true;
+        if (pc) {
+            pc->finalizar();
+        }
     }
-};
-
-void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, vector<int> &locais, Grafo &grafo);
-vector<vector<int>> GerarTodasAsCombinacoes(const vector<int> locais, map<int,int> demanda, int capacidade, Grafo &grafo);
-bool VerificarCapacidade(vector<int> rota, map<int,int> demanda, int capacidade);
-void encontrarMelhorCombinacao(const vector<vector<int>>& rotas, vector<vector<int>>& combinacaoAtual, int index, const vector<int>& locais, int& melhorCusto, vector<vector<int>>& melhorCombinacao, Grafo& grafo);
 
+    INSTR_FASE_FIM(faseBusca);
+    if (pararSolicitado) {
+        return 2;
+    }
+    if (melhorCusto < INT_MAX) {
+        melhorCusto += relaxacao.deslocamento;
+    }
+    if (usarCheckpoint) {
+        RemoverCheckpoint(opcoes.checkpoint, ".t");
+    }
+    // com a tabela em disco, "rotas" passa a ter só as rotas da solução, e o caminho aponta para elas
+    if (!opcoes.rotasDisco.empty()) {
+        rotas.clear();
+        for (int& indice : melhorCaminho) {
+            rotas.push_back(RotaDaMascara(tabela[indice].mascara, locais, matriz, deposito));
+            indice = rotas.size() - 1;
+        }
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]){
     auto start = std::chrono::high_resolution_clock::now();
-    if (argc < 2) {
-        cout << "Usage: " << argv[0] << " <file>" << endl;
+    Opcoes opcoes;
+    if (!LerOpcoes(argc, argv, opcoes)) {
+        ImprimirUso(argv[0]);
+        return 1;
+    }
+    if (!ConferirParticao(opcoes).empty()) {
+        cout << ConferirParticao(opcoes) << endl;
         return 1;
     }
-    string file = argv[1];
-    int capacidade = 10;
-    Grafo grafo;    
     map<int,int> demanda;
     vector<tuple<int, int , int>> arestas;
-    vector<int> locais;
     // Realiza a leitura do grafo
-    LerGrafo(file, demanda, arestas, locais, grafo);
+    INSTR_FASE(faseLeitura, LEITURA);
+    // a instância vem do arquivo ou, na reotimização incremental, do estado salvo com o delta aplicado
+    EstadoResolvido estado;
+    int numNos = 0;
+    if (!opcoes.estado.empty()) {
+        if (!CarregarEstado(opcoes, estado)) {
+            return 1;
+        }
+        demanda = estado.demanda;
+        arestas = estado.arestas;
+        numNos = estado.numNos;
+    } else {
+        LerGrafo(opcoes.arquivo, demanda, arestas, numNos, opcoes);
+    }
+    INSTR_FASE_FIM(faseLeitura);
+    AplicarPadroes(opcoes, 10);
+    vector<int> locais = ClientesSemDeposito(numNos, opcoes.deposito);
+    // o cache das ordens só é mantido quando vai ser reaproveitado ou gravado
+    CacheOrdens* cache = opcoes.estado.empty() && opcoes.salvarEstado.empty() ? nullptr : &estado.cache;
+    int capacidade = opcoes.capacidade;
+    int deposito = opcoes.deposito;
+    int frota = opcoes.frota;
 
     cout << "Local: "  << locais.size() << endl;
-    vector<vector<int>> rotas = GerarTodasAsCombinacoes(locais, demanda, capacidade, grafo);
-    cout << "Rotas: " << rotas.size() << endl;
-
-    int melhorCusto = INT_MAX;
+    INSTR_FASE(faseGeracao, GERACAO);
+    MatrizCustos matriz(numNos, arestas);
+    // a mesma instância (mesmo que com outra numeração dos clientes) já pode ter sido resolvida
+    ChaveInstancia chave = CalcularChave(opcoes.cache, numNos, demanda, capacidade, deposito, matriz);
+    vector<vector<int>> solucaoCache;
+    int custoCache;
+    if (LerSolucaoCache(chave, frota, opcoes.particao, matriz, deposito, solucaoCache, custoCache)) {
+        cout << "Cache: solucao encontrada" << endl;
+        ImprimirRotas(solucaoCache, matriz, deposito);
+        cout << "Menor custo: " << custoCache << endl;
+        if (!opcoes.salvarEstado.empty()) {
+            SalvarExecucao(opcoes, numNos, demanda, arestas, solucaoCache, estado);
+        }
+        std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+        std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
+        INSTR_FINALIZAR();
+        return 0;
+    }
+    vector<vector<int>> rotas;
+    if (!opcoes.rotasDisco.empty()) {
+        // a tabela é gerada direto no arquivo, dentro de BuscarMelhorCombinacao
+    } else if (LerRotasCache(chave, frota > 0, rotas, estado.cache, matriz, deposito)) {
+        cout << "Cache: tabela de rotas encontrada" << endl;
+        cache = &estado.cache;
+    } else {
+        rotas = GerarRotasCandidatas(locais, demanda, capacidade, matriz);
+    }
+    INSTR_FASE_FIM(faseGeracao);
+    if (opcoes.rotasDisco.empty()) {
+        cout << "Rotas: " << rotas.size() << endl;
+    }
 
-    vector<vector<int>> combinacaoAtual;
-    vector<vector<int>> melhorCombinacao;
+    // na reotimização, a solução anterior (se continua válida) já limita a busca desde o começo
+    int melhorCusto = LimiteInicial(estado, locais, demanda, opcoes, matriz, true);
+    vector<int> melhorCaminho;
+    LimiteLP relaxacao;
 
-    // Paralelizando a busca pela melhor combinação, começando por adicionar o bloco de pragma omp parallel, para que as threads tenham acesso ao trecho de código
-    #pragma omp parallel
-    {
-        vector<vector<int>> melhorCombinacaoLocal;
-        int melhorCustoLocal = INT_MAX; 
-        // Aqui para paralelizar o loop for, adicionamos o bloco de pragma omp for, com a cláusula schedule(dynamic) pois o tempo de verificaçõa das rotas pode ser bem diferente
-        #pragma omp for schedule(dynamic)
-        for (int i = 0; i < rotas.size(); i++) {
-            vector<vector<int>> combinacaoAtualLocal;
-            encontrarMelhorCombinacao(rotas, combinacaoAtualLocal, i, locais, melhorCustoLocal, melhorCombinacaoLocal, grafo);
-        }
-        // Adicionamos a região critica para garantir que apenas uma thread tenha acesso ao recurso compartilhado
-        #pragma omp critical
-        {
-            if (melhorCustoLocal < melhorCusto) {
-                melhorCusto = melhorCustoLocal;
-                melhorCombinacao = melhorCombinacaoLocal;
-            }
-        }
+    // a redução e a busca são compiladas para cada tipo de máscara e rodam com o menor em que cabem os clientes
+    int resultado = 0;
+    bool cabe = DespacharPorTamanho(locais.size(), [&](auto zero) {
+        resultado = BuscarMelhorCombinacao<decltype(zero)>(rotas, locais, demanda, matriz, deposito, frota, cache, opcoes, melhorCusto, melhorCaminho, relaxacao);
+    });
+    if (!cabe) {
+        cout << "Instancia com " << locais.size() << " clientes: o maximo suportado e " << BitsMascara<uint128_t>() << endl;
+        return 1;
+    }
+    if (resultado == 2) {
+        cout << "Busca interrompida; continue com --checkpoint " << opcoes.checkpoint << " --resume" << endl;
+        return 2;
+    }
+    if (resultado != 0) {
+        return resultado;
     }
 
     // Imprimir o resultado
+    if (melhorCaminho.empty()) {
+        cout << "Nenhuma solucao respeita a capacidade e a frota informadas" << endl;
+        return 1;
+    }
     cout << "Melhor combinação de rotas:" << endl;
-    for (const auto& rota : melhorCombinacao) {
+    for (int indice : melhorCaminho) {
+        const auto& rota = rotas[indice];
         cout << "{ ";
         for (int cidade : rota) {
             cout << cidade << " ";
         }
-        cout << "} com custo: " << grafo.calcularCustoRota(rota) << endl;
+        cout << "} com custo: " << matriz.custoRota(rota, deposito) << endl;
     }
     cout << "Menor custo: " << melhorCusto << endl;
+    if (relaxacao.ativo && melhorCusto < INT_MAX) {
+        cout << "Gap do LP: " << GapPercentual(melhorCusto, relaxacao.limite) << "%" << endl;
+    }
+    vector<vector<int>> solucao;
+    for (int indice : melhorCaminho) {
+        solucao.push_back(rotas[indice]);
+    }
+    GravarCache(chave, frota, opcoes.particao, opcoes.rotasDisco.empty() ? rotas : vector<vector<int>>(), solucao, melhorCusto);
+    if (!opcoes.salvarEstado.empty()) {
+        SalvarExecucao(opcoes, numNos, demanda, arestas, solucao, estado);
+    }
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
     std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
+    INSTR_FINALIZAR();
     return 0;
 }
 
-void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, vector<int> &locais, Grafo &grafo) {
+void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes) {
     ifstream arquivo;
     arquivo.open(file);
     if (arquivo.is_open()) {
-        int N; // número de locais a serem visitados
-        arquivo >> N;
-        N -= 1;
-        for (int i = 1; i <= N; i++) {
-            locais.push_back(i);
-        }
+        arquivo >> numNos;
         // Populando a lista de demandas dos locais
-        for (int i = 0; i < N; i++) {
+        for (int i = 0; i < numNos - 1; i++) {
             int id_no, demanda_no;
             arquivo >> id_no;
             arquivo >> demanda_no;
             demanda[id_no] = demanda_no;
         }
-        // número de aresyas
-        int K; // Declare a variável K antes de utilizá-la
-
-        arquivo >> K; // Leia o número de arestas do arquivo
-
+        int K; // número de arestas
+        arquivo >> K;
         for (int i = 0; i < K; i++) {
             int id_no1, id_no2, custo;
             arquivo >> id_no1;
             arquivo >> id_no2;
             arquivo >> custo;
             arestas.push_back(make_tuple(id_no1, id_no2, custo));
-            grafo.adicionarAresta(id_no1, id_no2, custo);
         }
+        LerParametrosArquivo(arquivo, opcoes);
     }
     arquivo.close();
 }
-
-bool VerificarCapacidade(vector<int> rota, map<int,int> demanda, int capacidade){
-    int demanda_total = 0;
-    for (auto& local : rota){
-        demanda_total += demanda[local];
-    }
-    return demanda_total <= capacidade;
-}
-
-// Função para gerar todas as combinações possíveis
-vector<vector<int>> GerarTodasAsCombinacoes(const vector<int> locais, map<int,int> demanda, int capacidade,Grafo &grafo) {
-    vector<vector<int>> rotas;
-    int n = locais.size();
-    for (int i = 1; i < (1 << n); i++) {
-        vector<int> rota;
-        for (int j = 0; j < n; j++) {
-            if (i & (1 << j)) {
-                rota.push_back(locais[j]);
-            }
-        }
-        if (VerificarCapacidade(rota, demanda, capacidade)){
-            if (grafo.verificarRotaValida(rota)){
-                rotas.push_back(rota);
-            }
-        }
-    }
-    return rotas;
-}
-
-
-// Função para verificar se uma combinação de rotas cobre todas as cidades
-bool cobreTodasCidades(const vector<vector<int>>& combinacao, const vector<int>& locais) {
-    set<int> cidadesCobertas;
-    for (const auto& rota : combinacao) {
-        for (int cidade : rota) {
-            cidadesCobertas.insert(cidade);
-        }
-    }
-    return cidadesCobertas.size() == locais.size();
-}
-// Trocando a implementação por uma implementação não recursiva para que cosnigamos aplicar a paralelização de melhor forma
-void encontrarMelhorCombinacao(const vector<vector<int>>& rotas, vector<vector<int>>& combinacaoAtual, int index, 
-                               const vector<int>& locais, int& melhorCusto, vector<vector<int>>& melhorCombinacao, Grafo& grafo) {
-    stack<pair<int, int>> pilha;
-    pilha.push(make_pair(index, 0));
-
-    while (!pilha.empty()) {
-        pair<int, int> topo = pilha.top();
-        pilha.pop();
-
-        int i = topo.first;
-        int opcao = topo.second;
-
-        if (opcao == 0) {
-            if (cobreTodasCidades(combinacaoAtual, locais)) {
-                int custoTotal = 0;
-                for (const auto& rota : combinacaoAtual) {
-                    custoTotal += grafo.calcularCustoRota(rota);
-                }
-                if (custoTotal < melhorCusto) {
-                    melhorCusto = custoTotal;
-                    melhorCombinacao = combinacaoAtual;
-                }
-                continue;
-            }
-        }
-
-        if (opcao == 0 && i < rotas.size()) {
-            combinacaoAtual.push_back(rotas[i]);
-            pilha.push(make_pair(i, 1));
-            pilha.push(make_pair(i + 1, 0));
-        } else if (opcao == 1) {
-            combinacaoAtual.pop_back();
-            pilha.push(make_pair(i + 1, 0));
-        }
-    }
-}
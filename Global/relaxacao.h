@@ -0,0 +1,651 @@
+#ifndef RELAXACAO_H
+#define RELAXACAO_H
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <deque>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+#include <climits>
+#include "mascara.h"
+#include "candidatos.h"
+#include "buscaIterativa.h"
+
+using namespace std;
+
+// Relaxação linear do problema de partição e limite inferior para o custo ótimo.
+//
+//   min  soma c_r x_r
+//   s.a. soma das x_r das rotas que atendem i = 1   para cada cliente i
+//        soma x_r <= frota                          (só com frota > 0)
+//        x_r >= 0
+//
+// O LP é resolvido por geração de colunas: um simplex revisado (inversa da base densa, m <= 129 linhas)
+// sobre um conjunto pequeno de rotas, que cresce com as rotas de custo reduzido negativo devolvidas pela
+// precificação. A precificação pode percorrer a tabela de rotas candidatas (PrecificarTabela) ou resolver
+// um caminho mínimo elementar com restrição de capacidade (PrecificarESPPRC), que não enumera as rotas.
+// Em cada precificação exata o limite de Lagrange z + K * (menor custo reduzido) é válido, com K o maior
+// número de rotas de uma solução, então há limite mesmo sem chegar ao ótimo do LP.
+//
+// Na busca exata (--relaxacao) os duais entram como custos reduzidos: com inteiros p_i tais que
+// c_r - soma p_i >= 0 para toda rota, trocar cada custo por c_r - soma p_i muda o custo de qualquer partição
+// pela mesma constante soma p_i, e a poda por custo da busca vira uma poda pelo limite dual (ver
+// ReponderarRotas).
+
+const double EPS_LP = 1e-9;
+const double EPS_PRECO = 1e-6;
+
+// Tolerância dos custos reduzidos na escala dos duais (com a penalidade das artificiais eles podem ser enormes)
+inline double ToleranciaPreco(const vector<double>& y) {
+    double maior = 1;
+    for (double v : y) {
+        maior = max(maior, fabs(v));
+    }
+    return EPS_PRECO * maior;
+}
+
+template <typename Mascara>
+struct ColunaLP {
+    Mascara mascara; // clientes atendidos (posições em locais)
+    double custo;
+    bool frota;      // entra na linha da frota
+};
+
+// Simplex revisado sobre as colunas do problema mestre restrito. As m primeiras colunas formam a base
+// inicial: uma artificial por cliente, com custo "grande" (aumentado enquanto alguma ficar positiva) e a
+// folga da frota.
+template <typename Mascara>
+class MestreLP {
+public:
+    MestreLP(int numClientes, int frota) : n(numClientes), m(numClientes + (frota > 0 ? 1 : 0)), frota(frota) {
+        for (int i = 0; i < n; i++) {
+            colunas.push_back({Mascara(Mascara(1) << i), 0.0, false});
+        }
+        if (frota > 0) {
+            colunas.push_back({Mascara(0), 0.0, true});
+        }
+        base.resize(m);
+        iota(base.begin(), base.end(), 0);
+        naBase.assign(m, 1);
+        binv.assign((size_t) m * m, 0.0);
+        for (int i = 0; i < m; i++) {
+            binv[(size_t) i * m + i] = 1.0;
+        }
+        xb.assign(m, 1.0);
+        if (frota > 0) {
+            xb[n] = frota;
+        }
+    }
+
+    void adicionar(const ColunaLP<Mascara>& c) {
+        colunas.push_back(c);
+        naBase.push_back(0);
+        custoMaximo = max(custoMaximo, c.custo);
+    }
+
+    int numColunas() const {
+        return colunas.size() - m;
+    }
+
+    // Resolve o LP com as colunas atuais
+    void otimizar() {
+        penalidade = max(penalidade, 10.0 * (1.0 + custoMaximo));
+        for (int i = 0; i < n; i++) {
+            colunas[i].custo = penalidade;
+        }
+        simplex();
+    }
+
+    // Alguma artificial ainda está na solução: faltam colunas ou a penalidade é pequena demais
+    bool artificiaisPositivas() const {
+        for (int i = 0; i < m; i++) {
+            if (base[i] < n && xb[i] > 1e-7) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Devolve false quando a penalidade já passa de mil vezes o custo de atender cada cliente com a rota
+    // mais cara: o LP é considerado inviável (daí em diante o double perde a precisão dos custos)
+    bool aumentarPenalidade() {
+        penalidade *= 10;
+        return penalidade <= 1000.0 * n * (1.0 + custoMaximo);
+    }
+
+    double valor() const {
+        double z = 0;
+        for (int i = 0; i < m; i++) {
+            z += colunas[base[i]].custo * xb[i];
+        }
+        return z;
+    }
+
+    // y_k = soma c_B(i) (B^-1)_ik; y[n] é o dual da frota (<= 0)
+    vector<double> duais() const {
+        vector<double> y(m, 0.0);
+        for (int k = 0; k < m; k++) {
+            for (int i = 0; i < m; i++) {
+                y[k] += colunas[base[i]].custo * binv[(size_t) k * m + i];
+            }
+        }
+        return y;
+    }
+
+    // Valor de cada coluna adicionada (na ordem de adicionar) na solução atual
+    vector<double> solucao() const {
+        vector<double> x(numColunas(), 0.0);
+        for (int i = 0; i < m; i++) {
+            if (base[i] >= m) {
+                x[base[i] - m] = xb[i];
+            }
+        }
+        return x;
+    }
+
+    const ColunaLP<Mascara>& coluna(int j) const {
+        return colunas[m + j];
+    }
+
+private:
+    template <typename Funcao>
+    void linhasDe(const ColunaLP<Mascara>& c, Funcao&& f) const {
+        for (Mascara resto = c.mascara; resto != 0; resto &= resto - 1) {
+            f(MenorBit(resto));
+        }
+        if (c.frota) {
+            f(n);
+        }
+    }
+
+    double reduzido(int j, const vector<double>& y) const {
+        double rc = colunas[j].custo;
+        linhasDe(colunas[j], [&](int k) { rc -= y[k]; });
+        return rc;
+    }
+
+    // inversa da base recalculada do zero (Gauss-Jordan), para os erros das atualizações não se acumularem
+    void refatorar() {
+        vector<double> b((size_t) m * m, 0.0);
+        for (int i = 0; i < m; i++) {
+            linhasDe(colunas[base[i]], [&](int k) { b[(size_t) k * m + i] = 1.0; });
+        }
+        vector<double> inv((size_t) m * m, 0.0);
+        for (int i = 0; i < m; i++) {
+            inv[(size_t) i * m + i] = 1.0;
+        }
+        for (int c = 0; c < m; c++) {
+            int pivo = c;
+            for (int l = c + 1; l < m; l++) {
+                if (fabs(b[(size_t) l * m + c]) > fabs(b[(size_t) pivo * m + c])) {
+                    pivo = l;
+                }
+            }
+            if (fabs(b[(size_t) pivo * m + c]) < EPS_LP) {
+                return;
+            }
+            for (int k = 0; k < m; k++) {
+                swap(b[(size_t) c * m + k], b[(size_t) pivo * m + k]);
+                swap(inv[(size_t) c * m + k], inv[(size_t) pivo * m + k]);
+            }
+            double d = b[(size_t) c * m + c];
+            for (int k = 0; k < m; k++) {
+                b[(size_t) c * m + k] /= d;
+                inv[(size_t) c * m + k] /= d;
+            }
+            for (int l = 0; l < m; l++) {
+                double f = b[(size_t) l * m + c];
+                if (l == c || f == 0) {
+                    continue;
+                }
+                for (int k = 0; k < m; k++) {
+                    b[(size_t) l * m + k] -= f * b[(size_t) c * m + k];
+                    inv[(size_t) l * m + k] -= f * inv[(size_t) c * m + k];
+                }
+            }
+        }
+        // inv está por linhas (inv[i][k]); binv guarda a coluna k contígua
+        for (int i = 0; i < m; i++) {
+            for (int k = 0; k < m; k++) {
+                binv[(size_t) k * m + i] = inv[(size_t) i * m + k];
+            }
+        }
+        for (int i = 0; i < m; i++) {
+            xb[i] = 0;
+            for (int k = 0; k < m; k++) {
+                xb[i] += binv[(size_t) k * m + i] * (k < n ? 1.0 : frota);
+            }
+            xb[i] = max(xb[i], 0.0);
+        }
+    }
+
+    // Dantzig enquanto há progresso; depois de muitos pivôs degenerados seguidos (partição de conjuntos é
+    // muito degenerada), regra de Bland, que não cicla
+    void simplex() {
+        int degenerados = 0;
+        vector<double> d(m);
+        for (int pivos = 0;; pivos++) {
+            if (pivos % 50 == 49) {
+                refatorar();
+            }
+            vector<double> y = duais();
+            bool bland = degenerados > 50;
+            int entra = -1;
+            double melhor = -EPS_LP * penalidade;
+            for (int j = 0; j < (int) colunas.size(); j++) {
+                if (naBase[j]) {
+                    continue;
+                }
+                double rc = reduzido(j, y);
+                if (rc < melhor) {
+                    entra = j;
+                    melhor = rc;
+                    if (bland) {
+                        break;
+                    }
+                }
+            }
+            if (entra < 0) {
+                return;
+            }
+            fill(d.begin(), d.end(), 0.0);
+            linhasDe(colunas[entra], [&](int k) {
+                for (int i = 0; i < m; i++) {
+                    d[i] += binv[(size_t) k * m + i];
+                }
+            });
+            int sai = -1;
+            double razao = 0;
+            for (int i = 0; i < m; i++) {
+                if (d[i] <= EPS_LP) {
+                    continue;
+                }
+                double r = xb[i] / d[i];
+                bool empate = sai >= 0 && fabs(r - razao) <= EPS_LP;
+                if (sai < 0 || r < razao - EPS_LP || (empate && (bland ? base[i] < base[sai] : d[i] > d[sai]))) {
+                    sai = i;
+                    razao = r;
+                }
+            }
+            if (sai < 0) {
+                return; // ilimitado: não acontece, todas as variáveis são limitadas pelas linhas
+            }
+            degenerados = razao <= EPS_LP ? degenerados + 1 : 0;
+            for (int i = 0; i < m; i++) {
+                if (i != sai) {
+                    xb[i] = max(0.0, xb[i] - d[i] * razao);
+                }
+            }
+            xb[sai] = razao;
+            for (int k = 0; k < m; k++) {
+                double* col = &binv[(size_t) k * m];
+                double p = col[sai] / d[sai];
+                if (p == 0) {
+                    continue;
+                }
+                for (int i = 0; i < m; i++) {
+                    col[i] -= d[i] * p;
+                }
+                col[sai] = p;
+            }
+            naBase[base[sai]] = 0;
+            naBase[entra] = 1;
+            base[sai] = entra;
+        }
+    }
+
+    int n, m, frota;
+    vector<ColunaLP<Mascara>> colunas;
+    vector<int> base;
+    vector<char> naBase;
+    vector<double> binv; // (B^-1)_ik em binv[k * m + i]
+    vector<double> xb;
+    double custoMaximo = 0;
+    double penalidade = 0;
+};
+
+// Resultado da precificação: as melhores colunas de custo reduzido negativo e, se ela foi exata, o menor
+// custo reduzido de todas as rotas
+template <typename Mascara>
+struct Precificacao {
+    vector<ColunaLP<Mascara>> colunas;
+    bool exata = true;
+    double menor = 0;
+};
+
+// Fica com as "maximo" colunas de menor custo reduzido (a melhor por máscara)
+template <typename Mascara>
+void EscolherColunas(unordered_map<Mascara, pair<double, double>, HashMascara>& achadas, int maximo, bool frota,
+                     vector<ColunaLP<Mascara>>& colunas) {
+    vector<pair<double, Mascara>> ordem;
+    for (const auto& a : achadas) {
+        ordem.push_back({a.second.first, a.first});
+    }
+    sort(ordem.begin(), ordem.end(), [](const pair<double, Mascara>& a, const pair<double, Mascara>& b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    });
+    for (int i = 0; i < (int) ordem.size() && i < maximo; i++) {
+        colunas.push_back({ordem[i].second, achadas[ordem[i].second].second, frota});
+    }
+}
+
+template <typename Mascara>
+double DualDaRota(Mascara mascara, const vector<double>& y) {
+    double soma = 0;
+    for (Mascara resto = mascara; resto != 0; resto &= resto - 1) {
+        soma += y[MenorBit(resto)];
+    }
+    return soma;
+}
+
+// Precificação pela tabela de rotas candidatas (todas as rotas já enumeradas)
+template <typename Mascara>
+Precificacao<Mascara> PrecificarTabela(TabelaRotas<Mascara> rotas, int n, int frota, const vector<double>& y, int maximo) {
+    Precificacao<Mascara> p;
+    double dualFrota = frota > 0 ? y[n] : 0.0;
+    double tolerancia = ToleranciaPreco(y);
+    unordered_map<Mascara, pair<double, double>, HashMascara> achadas;
+    for (const auto& r : rotas) {
+        double rc = r.custo - DualDaRota(r.mascara, y) - dualFrota;
+        p.menor = min(p.menor, rc);
+        if (rc < -tolerancia) {
+            auto it = achadas.find(r.mascara);
+            if (it == achadas.end() || rc < it->second.first) {
+                achadas[r.mascara] = {rc, (double) r.custo};
+            }
+        }
+    }
+    EscolherColunas(achadas, maximo, frota > 0, p.colunas);
+    return p;
+}
+
+// Rótulo do caminho mínimo elementar: caminho saindo do depósito que termina no cliente "no"
+template <typename Mascara>
+struct Rotulo {
+    Mascara visitados;
+    int no;
+    int carga;
+    double reduzido; // custo das arestas menos os duais dos clientes visitados
+    double custo;    // custo das arestas
+    bool vivo;
+};
+
+// Precificação pelo caminho mínimo elementar com capacidade (ESPPRC), por rótulos com dominância:
+// um rótulo domina outro no mesmo cliente se tem custo reduzido e carga menores ou iguais e visitou um
+// subconjunto dos clientes. Com "heuristica" a dominância ignora os visitados, o que descarta rótulos que
+// poderiam levar a colunas boas; serve para achar colunas depressa, mas não prova que não há outras.
+// Acima de "limiteRotulos" rótulos a precificação para e não é exata.
+template <typename Mascara>
+Precificacao<Mascara> PrecificarESPPRC(const vector<int>& locais, map<int,int>& demanda, int capacidade, const MatrizCustos& m,
+                                       int deposito, int frota, const vector<double>& y, int maximo, bool heuristica,
+                                       size_t limiteRotulos) {
+    int n = locais.size();
+    Precificacao<Mascara> p;
+    p.exata = !heuristica;
+    double dualFrota = frota > 0 ? y[n] : 0.0;
+    double tolerancia = ToleranciaPreco(y);
+    vector<int> dem(n);
+    for (int j = 0; j < n; j++) {
+        dem[j] = demanda[locais[j]];
+    }
+    vector<Rotulo<Mascara>> rotulos;
+    vector<vector<int>> vivos(n);
+    deque<int> fila;
+    unordered_map<Mascara, pair<double, double>, HashMascara> achadas;
+
+    auto domina = [heuristica](const Rotulo<Mascara>& a, const Rotulo<Mascara>& b) {
+        return a.reduzido <= b.reduzido + EPS_LP && a.carga <= b.carga && (heuristica || (a.visitados & ~b.visitados) == 0);
+    };
+    auto inserir = [&](const Rotulo<Mascara>& novo) {
+        vector<int>& lista = vivos[novo.no];
+        for (int i : lista) {
+            if (domina(rotulos[i], novo)) {
+                return;
+            }
+        }
+        size_t k = 0;
+        for (int i : lista) {
+            if (domina(novo, rotulos[i])) {
+                rotulos[i].vivo = false;
+            } else {
+                lista[k++] = i;
+            }
+        }
+        lista.resize(k);
+        lista.push_back(rotulos.size());
+        fila.push_back(rotulos.size());
+        rotulos.push_back(novo);
+    };
+
+    for (int j = 0; j < n; j++) {
+        int aresta = m(deposito, locais[j]);
+        if (aresta < CUSTO_INFINITO && dem[j] <= capacidade) {
+            inserir({Mascara(Mascara(1) << j), j, dem[j], aresta - y[j], (double) aresta, true});
+        }
+    }
+    while (!fila.empty()) {
+        if (rotulos.size() > limiteRotulos) {
+            p.exata = false;
+            break;
+        }
+        Rotulo<Mascara> r = rotulos[fila.front()];
+        fila.pop_front();
+        if (!r.vivo) {
+            continue;
+        }
+        int volta = m(locais[r.no], deposito);
+        if (volta < CUSTO_INFINITO) {
+            double rc = r.reduzido + volta - dualFrota;
+            p.menor = min(p.menor, rc);
+            if (rc < -tolerancia) {
+                auto it = achadas.find(r.visitados);
+                if (it == achadas.end() || rc < it->second.first) {
+                    achadas[r.visitados] = {rc, r.custo + volta};
+                }
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            int aresta = m(locais[r.no], locais[k]);
+            if (((r.visitados >> k) & 1) || r.carga + dem[k] > capacidade || aresta >= CUSTO_INFINITO) {
+                continue;
+            }
+            inserir({Mascara(r.visitados | (Mascara(1) << k)), k, r.carga + dem[k], r.reduzido + aresta - y[k], r.custo + aresta, true});
+        }
+    }
+    EscolherColunas(achadas, maximo, frota > 0, p.colunas);
+    return p;
+}
+
+// Resultado da relaxação
+struct Relaxacao {
+    bool viavel = true;
+    bool otima = false;     // o LP foi resolvido até o fim (limite = valor do LP)
+    double limite = 0;      // limite inferior válido para qualquer solução inteira
+    double valor = 0;       // valor do último problema mestre
+    vector<double> duais;   // por cliente (posição em locais) e, com frota, o da frota no fim
+    int colunas = 0;
+    int iteracoes = 0;
+};
+
+// Geração de colunas: precificar(y, heuristica) devolve uma Precificacao. Enquanto a heurística acha
+// colunas ela é usada; a exata só roda quando ela não acha mais nada.
+template <typename Mascara, typename Precificador>
+Relaxacao GerarColunas(int n, int frota, Precificador&& precificar, int maxIteracoes = 100000) {
+    Relaxacao r;
+    r.limite = -INFINITY;
+    MestreLP<Mascara> lp(n, frota);
+    int maxRotas = frota > 0 ? min(frota, n) : n;
+    for (r.iteracoes = 0; r.iteracoes < maxIteracoes; r.iteracoes++) {
+        lp.otimizar();
+        r.valor = lp.valor();
+        r.duais = lp.duais();
+        Precificacao<Mascara> p = precificar(r.duais, true);
+        if (p.colunas.empty()) {
+            p = precificar(r.duais, false);
+        }
+        if (p.exata) {
+            r.limite = max(r.limite, r.valor + maxRotas * min(0.0, p.menor));
+        }
+        if (p.colunas.empty()) {
+            // sem colunas novas e com artificial positiva, ou a penalidade ainda não basta ou não há solução
+            if (p.exata && lp.artificiaisPositivas()) {
+                if (!lp.aumentarPenalidade()) {
+                    r.viavel = false;
+                    return r;
+                }
+                continue;
+            }
+            r.otima = p.exata;
+            break;
+        }
+        for (const auto& c : p.colunas) {
+            lp.adicionar(c);
+        }
+    }
+    r.colunas = lp.numColunas();
+    return r;
+}
+
+// Relaxação sobre a tabela de rotas candidatas da busca exata
+template <typename Mascara>
+Relaxacao RelaxacaoDaTabela(TabelaRotas<Mascara> rotas, int n, int frota) {
+    return GerarColunas<Mascara>(n, frota, [&](const vector<double>& y, bool heuristica) {
+        // a tabela inteira é percorrida de qualquer jeito: não há precificação heurística
+        if (heuristica) {
+            return Precificacao<Mascara>();
+        }
+        return PrecificarTabela(rotas, n, frota, y, 100);
+    });
+}
+
+// Relaxação sem enumerar as rotas (precificação por ESPPRC)
+template <typename Mascara>
+Relaxacao RelaxacaoPorCaminhos(const vector<int>& locais, map<int,int>& demanda, int capacidade, const MatrizCustos& m, int deposito,
+                               int frota, size_t limiteRotulos) {
+    return GerarColunas<Mascara>(locais.size(), frota, [&](const vector<double>& y, bool heuristica) {
+        return PrecificarESPPRC<Mascara>(locais, demanda, capacidade, m, deposito, frota, y, 50, heuristica, limiteRotulos);
+    });
+}
+
+// Menor inteiro que é limite inferior para o custo (inteiro) de uma solução; a tolerância relativa absorve o
+// erro de arredondamento do simplex
+inline long long ArredondarLimite(double limite) {
+    return (long long) ceil(limite - EPS_PRECO * max(1.0, fabs(limite)));
+}
+
+// Gap relativo (em %, com duas casas) de uma solução de custo "custo" em relação ao limite inferior
+inline double GapPercentual(double custo, double limite) {
+    return custo > 0 ? round(10000.0 * (custo - ArredondarLimite(limite)) / custo) / 100 : 0.0;
+}
+
+// Troca o custo de cada rota por c_r - soma p_i, com p_i inteiros e c_r - soma p_i >= 0 em toda a tabela,
+// e reordena cada grupo (e "rotas", na mesma ordem) pelo custo novo. Os p_i partem dos duais arredondados
+// para baixo e depois cada cliente sobe enquanto todas as rotas que o atendem continuam com custo >= 0.
+// Devolve a soma dos p_i, que é o que some do custo de toda partição.
+template <typename Mascara>
+long long ReponderarRotas(vector<vector<int>>& rotas, vector<RotaCompacta<Mascara>>& compactas, int n, const vector<double>& duais) {
+    vector<long long> p(n);
+    for (int i = 0; i < n; i++) {
+        p[i] = (long long) floor(duais[i] - EPS_PRECO);
+    }
+    auto reduzido = [&](const RotaCompacta<Mascara>& r) {
+        long long rc = r.custo;
+        for (Mascara resto = r.mascara; resto != 0; resto &= resto - 1) {
+            rc -= p[MenorBit(resto)];
+        }
+        return rc;
+    };
+    // erro numérico nos duais: recomeça dos zeros, que sempre servem
+    for (const auto& r : compactas) {
+        if (reduzido(r) < 0) {
+            fill(p.begin(), p.end(), 0);
+            break;
+        }
+    }
+    for (int passo = 0; passo < n; passo++) {
+        vector<long long> folga(n, LLONG_MAX);
+        for (const auto& r : compactas) {
+            long long rc = reduzido(r);
+            for (Mascara resto = r.mascara; resto != 0; resto &= resto - 1) {
+                int i = MenorBit(resto);
+                folga[i] = min(folga[i], rc);
+            }
+        }
+        int melhor = max_element(folga.begin(), folga.end()) - folga.begin();
+        if (folga[melhor] <= 0) {
+            break;
+        }
+        // cliente que não aparece em nenhuma rota: não há partição, nada a ganhar
+        if (folga[melhor] == LLONG_MAX) {
+            break;
+        }
+        p[melhor] += folga[melhor];
+    }
+    for (auto& r : compactas) {
+        r.custo = (int) reduzido(r);
+    }
+    vector<int> ordem(compactas.size());
+    iota(ordem.begin(), ordem.end(), 0);
+    stable_sort(ordem.begin(), ordem.end(), [&](int a, int b) {
+        int menorA = MenorBit(compactas[a].mascara), menorB = MenorBit(compactas[b].mascara);
+        if (menorA != menorB) {
+            return menorA < menorB;
+        }
+        return compactas[a].custo < compactas[b].custo;
+    });
+    vector<RotaCompacta<Mascara>> novasCompactas;
+    vector<vector<int>> novasRotas;
+    novasCompactas.reserve(compactas.size());
+    novasRotas.reserve(rotas.size());
+    for (int i : ordem) {
+        novasCompactas.push_back(compactas[i]);
+        novasRotas.push_back(std::move(rotas[i]));
+    }
+    compactas.swap(novasCompactas);
+    rotas.swap(novasRotas);
+    return accumulate(p.begin(), p.end(), 0LL);
+}
+
+// Limite do LP usado pela busca exata
+struct LimiteLP {
+    bool ativo = false;
+    double limite = 0;
+    long long deslocamento = 0; // soma dos p_i: custo real = custo na busca + deslocamento
+};
+
+// Calcula a relaxação sobre a tabela da busca, imprime o limite e troca os custos das rotas pelos custos
+// reduzidos. O limite inicial da busca (melhorCusto) passa para a mesma escala.
+template <typename Mascara>
+LimiteLP AplicarRelaxacao(vector<vector<int>>& rotas, vector<RotaCompacta<Mascara>>& compactas, int n, int frota, int& melhorCusto,
+                          bool imprimir) {
+    LimiteLP lp;
+    Relaxacao r = RelaxacaoDaTabela<Mascara>(compactas, n, frota);
+    if (!r.viavel) {
+        if (imprimir) {
+            cout << "Relaxacao inviavel: nenhuma solucao" << endl;
+        }
+        return lp;
+    }
+    // com a frota a linha dela também tem dual, que não cabe na troca de custos: os duais vêm do LP sem ela
+    // (um limite um pouco mais fraco, mas igualmente válido)
+    vector<double> duais = r.duais;
+    if (frota > 0) {
+        Relaxacao semFrota = RelaxacaoDaTabela<Mascara>(compactas, n, 0);
+        duais = semFrota.duais;
+    }
+    lp.ativo = true;
+    lp.limite = r.limite;
+    lp.deslocamento = ReponderarRotas(rotas, compactas, n, duais);
+    if (melhorCusto < INT_MAX) {
+        melhorCusto -= lp.deslocamento;
+    }
+    if (imprimir) {
+        cout << "Limite inferior (LP): " << round(r.limite * 100) / 100 << " (" << r.colunas << " colunas, " << r.iteracoes << " iteracoes)" << endl;
+    }
+    return lp;
+}
+
+#endif
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <cmath>
+#include "candidatos.h"
+#include "opcoes.h"
+#include "incremental.h"
+#include "buscaIterativa.h"
+#include "relaxacao.h"
+
+using namespace std;
+
+// Limite inferior da relaxação linear de uma instância e gap de uma solução em relação a ele.
+// Por padrão as rotas vêm da geração de colunas por caminhos mínimos (sem enumerar os subconjuntos);
+// com --enumerar o LP é resolvido sobre a tabela de rotas candidatas dos solvers exatos. O custo a comparar
+// vem de --custo X ou da solução gravada num estado (--estado E, de qualquer solver, inclusive a decomposição).
+
+struct ParametrosRelaxacao {
+    bool enumerar = false;
+    long long custo = -1;                 // -1 = só o limite
+    long long limiteRotulos = 5000000;    // por precificação por caminhos
+};
+
+inline bool LerOpcoesRelaxacao(int argc, char* argv[], Opcoes& op, ParametrosRelaxacao& pr) {
+    vector<char*> resto = {argv[0]};
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--enumerar") {
+            pr.enumerar = true;
+        } else if ((arg == "--custo" || arg == "--limite-rotulos") && i + 1 < argc) {
+            (arg == "--custo" ? pr.custo : pr.limiteRotulos) = stoll(argv[++i]);
+        } else {
+            resto.push_back(argv[i]);
+        }
+    }
+    return LerOpcoes((int) resto.size(), resto.data(), op);
+}
+
+void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes);
+
+int main(int argc, char* argv[]){
+    auto start = std::chrono::high_resolution_clock::now();
+    Opcoes opcoes;
+    ParametrosRelaxacao parametros;
+    if (!LerOpcoesRelaxacao(argc, argv, opcoes, parametros)) {
+        ImprimirUso(argv[0]);
+        cout << "       (relaxacao) [--enumerar] [--custo X] [--limite-rotulos N]" << endl;
+        return 1;
+    }
+    map<int,int> demanda;
+    vector<tuple<int, int , int>> arestas;
+    EstadoResolvido estado;
+    int numNos = 0;
+    if (!opcoes.estado.empty()) {
+        if (!CarregarEstado(opcoes, estado)) {
+            return 1;
+        }
+        demanda = estado.demanda;
+        arestas = estado.arestas;
+        numNos = estado.numNos;
+    } else {
+        LerGrafo(opcoes.arquivo, demanda, arestas, numNos, opcoes);
+    }
+    AplicarPadroes(opcoes, 10);
+    vector<int> locais = ClientesSemDeposito(numNos, opcoes.deposito);
+    cout << "Local: " << locais.size() << endl;
+    MatrizCustos matriz(numNos, arestas);
+    // a solução do estado, se ainda for válida com o delta, é a que tem o gap calculado
+    if (parametros.custo < 0 && !estado.solucao.empty()) {
+        int limite = LimiteInicial(estado, locais, demanda, opcoes, matriz, true);
+        if (limite < INT_MAX) {
+            parametros.custo = limite - 1;
+        }
+    }
+
+    Relaxacao r;
+    bool cabe = DespacharPorTamanho(locais.size(), [&](auto zero) {
+        using Mascara = decltype(zero);
+        if (parametros.enumerar) {
+            vector<vector<int>> rotas = GerarRotasCandidatas(locais, demanda, opcoes.capacidade, matriz);
+            cout << "Rotas: " << rotas.size() << endl;
+            ReduzirCandidatos<Mascara>(rotas, locais, matriz, opcoes.deposito, opcoes.frota > 0);
+            vector<RotaCompacta<Mascara>> compactas = CompactarRotas<Mascara>(rotas, locais, demanda, matriz, opcoes.deposito);
+            r = RelaxacaoDaTabela<Mascara>(compactas, locais.size(), opcoes.frota);
+        } else {
+            r = RelaxacaoPorCaminhos<Mascara>(locais, demanda, opcoes.capacidade, matriz, opcoes.deposito, opcoes.frota,
+                                              parametros.limiteRotulos);
+        }
+    });
+    if (!cabe) {
+        cout << "Instancia com " << locais.size() << " clientes: o maximo suportado e " << BitsMascara<uint128_t>() << endl;
+        return 1;
+    }
+    if (!r.viavel) {
+        cout << "Relaxacao inviavel: nenhuma solucao respeita a capacidade e a frota informadas" << endl;
+        return 1;
+    }
+    cout << "Colunas: " << r.colunas << " em " << r.iteracoes << " iteracoes" << endl;
+    if (r.limite == -INFINITY) {
+        cout << "Limite inferior indisponivel: a precificacao passou de " << parametros.limiteRotulos << " rotulos" << endl;
+        return 1;
+    }
+    if (!r.otima) {
+        cout << "Aviso: LP nao resolvido ate o fim (ultimo mestre: " << r.valor << ")" << endl;
+    }
+    cout << "Limite inferior (LP): " << round(r.limite * 100) / 100 << endl;
+    cout << "Limite inferior inteiro: " << ArredondarLimite(r.limite) << endl;
+    if (parametros.custo >= 0) {
+        cout << "Solucao: " << parametros.custo << endl;
+        cout << "Gap: " << GapPercentual(parametros.custo, r.limite) << "%" << endl;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
+    return 0;
+}
+
+void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, int &numNos, Opcoes &opcoes) {
+    ifstream arquivo;
+    arquivo.open(file);
+    if (arquivo.is_open()) {
+        arquivo >> numNos;
+        // Populando a lista de demandas dos locais
+        for (int i = 0; i < numNos - 1; i++) {
+            int id_no, demanda_no;
+            arquivo >> id_no;
+            arquivo >> demanda_no;
+            demanda[id_no] = demanda_no;
+        }
+        int K; // número de arestas
+        arquivo >> K;
+        for (int i = 0; i < K; i++) {
+            int id_no1, id_no2, custo;
+            arquivo >> id_no1;
+            arquivo >> id_no2;
+            arquivo >> custo;
+            arestas.push_back(make_tuple(id_no1, id_no2, custo));
+        }
+        LerParametrosArquivo(arquivo, opcoes);
+    }
+    arquivo.close();
+}
@@ -0,0 +1,276 @@
+#ifndef ROTAS_DISCO_H
+#define ROTAS_DISCO_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+#include "buscaIterativa.h"
+#include "candidatos.h"
+
+using namespace std;
+
+// Tabela de rotas candidatas em disco, para instâncias cujas rotas não cabem na memória (solver OpenMP,
+// --rotas-disco ARQ).
+//
+// Na memória, cada rota gerada é um vector<int> próprio dentro de um vector<vector<int>>, mais a cópia
+// compacta usada pela busca. Aqui cada rota sai do gerador (PercorrerRotasCandidatas) direto para um
+// registro RotaCompacta de tamanho fixo, já com o custo da melhor ordem, e os registros vão para o arquivo
+// na ordem que a busca espera (menor cliente, custo e máscara):
+//  - os registros são acumulados até --memoria-rotas MB, ordenados e gravados em sequência num bloco
+//    temporário (ARQ.bloco<k>);
+//  - no fim os blocos são intercalados, lidos e gravados sequencialmente, no arquivo final. Com um bloco só
+//    ele é gravado direto. O gerador já produz as rotas agrupadas pelo menor cliente, então na prática
+//    a intercalação só mistura os blocos de um mesmo grupo.
+// A busca lê o arquivo com mmap, e o sistema operacional traz para a memória só as páginas usadas. O grupo
+// do cliente 0, de longe o maior, é lido uma vez em sequência (cada registro é uma tarefa); os outros grupos
+// são revisitados em todo ramo e são pedidos ao kernel logo na abertura (madvise).
+// A redução por dominância de ReduzirCandidatos precisa de todas as máscaras na memória e não é feita:
+// a tabela tem mais rotas, mas a melhor partição é a mesma. A ordem das rotas da solução é recalculada no
+// fim a partir das máscaras (só as rotas escolhidas).
+
+const char MAGIA_ROTAS[8] = {'V', 'R', 'P', 'R', 'O', 'T', 'A', '1'};
+
+// 64 bytes, para os registros (até 32 bytes com máscara de 128 bits) ficarem alinhados no mmap
+struct CabecalhoRotas {
+    char magia[8];
+    int32_t bitsMascara;
+    int32_t tamanhoRegistro;
+    int64_t numRotas;
+    char reservado[40];
+};
+
+// Ordem da tabela: grupo do menor cliente, custo crescente e, no empate, a máscara (para o arquivo e as
+// tarefas serem sempre os mesmos, o que o checkpoint exige)
+template <typename Mascara>
+bool AntesNaTabela(const RotaCompacta<Mascara>& a, const RotaCompacta<Mascara>& b) {
+    int menorA = MenorBit(a.mascara), menorB = MenorBit(b.mascara);
+    if (menorA != menorB) {
+        return menorA < menorB;
+    }
+    if (a.custo != b.custo) {
+        return a.custo < b.custo;
+    }
+    return a.mascara < b.mascara;
+}
+
+// Leitura sequencial de um bloco ordenado durante a intercalação
+template <typename Mascara>
+struct LeitorBloco {
+    FILE* arquivo = nullptr;
+    vector<RotaCompacta<Mascara>> buffer;
+    size_t posicao = 0;
+
+    bool proximo(RotaCompacta<Mascara>& r) {
+        if (posicao == buffer.size()) {
+            buffer.resize(buffer.capacity());
+            buffer.resize(fread(buffer.data(), sizeof(RotaCompacta<Mascara>), buffer.size(), arquivo));
+            posicao = 0;
+            if (buffer.empty()) {
+                return false;
+            }
+        }
+        r = buffer[posicao++];
+        return true;
+    }
+};
+
+// Gera as rotas candidatas de "locais" e grava a tabela ordenada em "caminho", usando no máximo cerca de
+// "memoria" bytes para os registros. Devolve false em erro de escrita.
+template <typename Mascara>
+bool GravarRotasDisco(const string& caminho, const vector<int>& locais, map<int,int>& demanda, int capacidade, const MatrizCustos& m,
+                      int deposito, size_t memoria, long long& total) {
+    vector<int> bit(*max_element(locais.begin(), locais.end()) + 1, -1);
+    for (int j = 0; j < (int) locais.size(); j++) {
+        bit[locais[j]] = j;
+    }
+    size_t porBloco = max<size_t>(1024, memoria / sizeof(RotaCompacta<Mascara>));
+    vector<RotaCompacta<Mascara>> bloco;
+    vector<string> blocos;
+    bool ok = true;
+    total = 0;
+
+    CabecalhoRotas cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magia, MAGIA_ROTAS, sizeof(cabecalho.magia));
+    cabecalho.bitsMascara = BitsMascara<Mascara>();
+    cabecalho.tamanhoRegistro = sizeof(RotaCompacta<Mascara>);
+
+    // o arquivo final é escrito num temporário e renomeado, como o cache e o checkpoint
+    string temporario = caminho + ".tmp";
+    auto gravarFinal = [&](const function<bool(FILE*)>& registros) {
+        FILE* f = fopen(temporario.c_str(), "wb");
+        if (!f) {
+            return false;
+        }
+        setvbuf(f, nullptr, _IOFBF, 1 << 20);
+        cabecalho.numRotas = total;
+        bool escrito = fwrite(&cabecalho, sizeof(cabecalho), 1, f) == 1 && registros(f);
+        escrito = fclose(f) == 0 && escrito;
+        return escrito && rename(temporario.c_str(), caminho.c_str()) == 0;
+    };
+    auto descarregar = [&]() {
+        sort(bloco.begin(), bloco.end(), AntesNaTabela<Mascara>);
+        string nome = caminho + ".bloco" + to_string(blocos.size());
+        FILE* f = fopen(nome.c_str(), "wb");
+        ok = ok && f && fwrite(bloco.data(), sizeof(RotaCompacta<Mascara>), bloco.size(), f) == bloco.size();
+        ok = f && fclose(f) == 0 && ok;
+        blocos.push_back(nome);
+        bloco.clear();
+    };
+
+    vector<int> ordem;
+    PercorrerRotasCandidatas(locais, demanda, capacidade, m, [&](const vector<int>& rota, int carga) {
+        RotaCompacta<Mascara> r = {0, OrdenarRota(m, deposito, rota, ordem), carga};
+        for (int cidade : rota) {
+            r.mascara |= Mascara(1) << bit[cidade];
+        }
+        bloco.push_back(r);
+        total++;
+        if (bloco.size() >= porBloco) {
+            descarregar();
+        }
+    });
+
+    if (blocos.empty()) {
+        sort(bloco.begin(), bloco.end(), AntesNaTabela<Mascara>);
+        return gravarFinal([&](FILE* f) {
+            return fwrite(bloco.data(), sizeof(RotaCompacta<Mascara>), bloco.size(), f) == bloco.size();
+        });
+    }
+    if (!bloco.empty()) {
+        descarregar();
+    }
+    vector<RotaCompacta<Mascara>>().swap(bloco);
+
+    // intercalação dos blocos: a memória disponível é dividida entre os buffers de leitura
+    vector<LeitorBloco<Mascara>> leitores(blocos.size());
+    for (size_t k = 0; k < blocos.size(); k++) {
+        leitores[k].arquivo = fopen(blocos[k].c_str(), "rb");
+        ok = ok && leitores[k].arquivo;
+        leitores[k].buffer.reserve(max<size_t>(1024, porBloco / blocos.size()));
+    }
+    if (ok) {
+        ok = gravarFinal([&](FILE* f) {
+            typedef pair<RotaCompacta<Mascara>, int> Item;
+            auto depois = [](const Item& a, const Item& b) {
+                return AntesNaTabela(b.first, a.first);
+            };
+            priority_queue<Item, vector<Item>, decltype(depois)> fila(depois);
+            RotaCompacta<Mascara> r;
+            for (size_t k = 0; k < leitores.size(); k++) {
+                if (leitores[k].proximo(r)) {
+                    fila.push({r, (int) k});
+                }
+            }
+            while (!fila.empty()) {
+                Item menor = fila.top();
+                fila.pop();
+                if (fwrite(&menor.first, sizeof(menor.first), 1, f) != 1) {
+                    return false;
+                }
+                if (leitores[menor.second].proximo(r)) {
+                    fila.push({r, menor.second});
+                }
+            }
+            return true;
+        });
+    }
+    for (size_t k = 0; k < blocos.size(); k++) {
+        if (leitores[k].arquivo) {
+            fclose(leitores[k].arquivo);
+        }
+        remove(blocos[k].c_str());
+    }
+    return ok;
+}
+
+// Tabela gravada por GravarRotasDisco mapeada em memória (só leitura)
+template <typename Mascara>
+class RotasEmDisco {
+public:
+    RotasEmDisco() {}
+    RotasEmDisco(const RotasEmDisco&) = delete;
+    RotasEmDisco& operator=(const RotasEmDisco&) = delete;
+
+    ~RotasEmDisco() {
+        if (base) {
+            munmap(base, tamanho);
+        }
+    }
+
+    bool abrir(const string& caminho, int numClientes) {
+        int fd = open(caminho.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0 && (size_t) info.st_size >= sizeof(CabecalhoRotas);
+        if (ok) {
+            tamanho = info.st_size;
+            base = mmap(nullptr, tamanho, PROT_READ, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) {
+                base = nullptr;
+                ok = false;
+            }
+        }
+        close(fd);
+        if (!ok) {
+            return false;
+        }
+        const CabecalhoRotas* c = (const CabecalhoRotas*) base;
+        if (memcmp(c->magia, MAGIA_ROTAS, sizeof(c->magia)) != 0 || c->bitsMascara != BitsMascara<Mascara>()
+            || c->tamanhoRegistro != (int) sizeof(RotaCompacta<Mascara>)
+            || sizeof(CabecalhoRotas) + (size_t) c->numRotas * sizeof(RotaCompacta<Mascara>) != tamanho) {
+            return false;
+        }
+        registros = TabelaRotas<Mascara>((const RotaCompacta<Mascara>*) ((const char*) base + sizeof(CabecalhoRotas)), c->numRotas);
+        AvisarAcesso(numClientes);
+        return true;
+    }
+
+    TabelaRotas<Mascara> tabela() const {
+        return registros;
+    }
+
+private:
+    // O grupo do cliente 0 é percorrido uma vez, em ordem; o resto da tabela é relido em todo ramo da busca
+    void AvisarAcesso(int numClientes) {
+        vector<int> inicio = InicioPorCliente(registros, numClientes);
+        long pagina = sysconf(_SC_PAGESIZE);
+        char* comeco = (char*) base;
+        char* fimGrupo0 = (char*) (registros.data() + inicio[1]);
+        char* resto = comeco + (fimGrupo0 - comeco) / pagina * pagina;
+        madvise(comeco, resto - comeco, MADV_SEQUENTIAL);
+        madvise(resto, comeco + tamanho - resto, MADV_WILLNEED);
+    }
+
+    void* base = nullptr;
+    size_t tamanho = 0;
+    TabelaRotas<Mascara> registros;
+};
+
+// Rota (na melhor ordem) correspondente a uma máscara da tabela
+template <typename Mascara>
+vector<int> RotaDaMascara(Mascara mascara, const vector<int>& locais, const MatrizCustos& m, int deposito) {
+    vector<int> clientes, ordem;
+    for (int j = 0; j < (int) locais.size(); j++) {
+        if ((mascara >> j) & 1) {
+            clientes.push_back(locais[j]);
+        }
+    }
+    OrdenarRota(m, deposito, clientes, ordem);
+    return ordem;
+}
+
+#endif
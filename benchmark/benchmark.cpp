@@ -0,0 +1,435 @@
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+// Harness de benchmark: roda cada solver listado em solvers.txt sobre cada instância de instancias.txt,
+// repetindo as execuções e resumindo tempo de parede (mediana e p95), nós explorados, rotas geradas,
+// pico de memória (RSS) e custo da solução em CSV e JSON. O custo dos solvers exatos é conferido com o
+// da versão original (esperados.txt), então uma mudança na busca que altere a resposta aparece como regressão.
+
+struct Solver {
+    string nome;
+    string comando; // "{arquivo}" é substituído pelo caminho da instância
+};
+
+struct Execucao {
+    string instancia;
+    string solver;
+    int repeticao;
+    bool ok;
+    bool estourouTempo;
+    int codigoSaida;
+    double tempo;       // segundos (tempo de parede)
+    long picoRssKb;     // ru_maxrss do processo e dos seus filhos
+    long long nos;      // "Nos explorados:" (-1 se o solver não informa)
+    long long rotas;    // "Rotas:" (-1 se o solver não informa)
+    long long custo;    // "Menor custo:" / "Custo total:" (-1 se não encontrado)
+};
+
+// Custo ótimo esperado de cada instância, conferido só nos solvers listados (os exatos)
+struct Esperados {
+    set<string> solvers;
+    map<string, long long> custos;
+};
+
+struct Config {
+    string arquivoInstancias = "benchmark/instancias.txt";
+    string arquivoSolvers = "benchmark/solvers.txt";
+    string arquivoEsperados = "benchmark/esperados.txt";
+    string saida = "benchmark/resultados";
+    int repeticoes = 5;
+    int aquecimento = 1;
+    double timeout = 300.0;
+    string filtroSolver;
+    string gerador = "./bin/gerador";
+};
+
+bool LerConfig(int argc, char* argv[], Config &config);
+bool LerInstancias(string file, const string& gerador, string &versao, vector<string> &instancias);
+bool LerSolvers(string file, vector<Solver> &solvers);
+bool LerEsperados(string file, Esperados &esperados);
+Execucao RodarComando(const string& comando, double timeout, string &saidaProcesso);
+void ExtrairMetricas(const string& saidaProcesso, Execucao &execucao);
+double Percentil(vector<double> valores, double p);
+void EscreverResultados(const Config& config, const string& versao, const vector<Execucao>& execucoes);
+
+int main(int argc, char* argv[]){
+    Config config;
+    if (!LerConfig(argc, argv, config)) {
+        cout << "Usage: " << argv[0] << " [--instancias arquivo] [--solvers arquivo] [--repeticoes N] [--aquecimento N] [--timeout segundos] [--saida prefixo] [--solver nome] [--gerador binario] [--esperados arquivo]" << endl;
+        return 1;
+    }
+
+    string versao;
+    vector<string> instancias;
+    vector<Solver> solvers;
+    if (!LerInstancias(config.arquivoInstancias, config.gerador, versao, instancias)) {
+        cout << "Erro ao ler o conjunto de instâncias: " << config.arquivoInstancias << endl;
+        return 1;
+    }
+    if (!LerSolvers(config.arquivoSolvers, solvers)) {
+        cout << "Erro ao ler a lista de solvers: " << config.arquivoSolvers << endl;
+        return 1;
+    }
+    Esperados esperados;
+    if (!LerEsperados(config.arquivoEsperados, esperados)) {
+        cout << "Erro ao ler os custos esperados: " << config.arquivoEsperados << endl;
+        return 1;
+    }
+    cout << "Conjunto de instâncias versão " << versao << ": " << instancias.size() << " instâncias, " << solvers.size() << " solvers" << endl;
+
+    vector<Execucao> execucoes;
+    int regressoes = 0;
+    for (const auto& instancia : instancias) {
+        for (const auto& solver : solvers) {
+            if (!config.filtroSolver.empty() && solver.nome != config.filtroSolver) {
+                continue;
+            }
+            string comando = solver.comando;
+            size_t pos = comando.find("{arquivo}");
+            while (pos != string::npos) {
+                comando.replace(pos, 9, instancia);
+                pos = comando.find("{arquivo}", pos + instancia.size());
+            }
+
+            // as execuções de aquecimento não entram no resumo (cache de disco, páginas do binário, etc.)
+            for (int r = 0; r < config.aquecimento; r++) {
+                string descarte;
+                RodarComando(comando, config.timeout, descarte);
+            }
+            for (int r = 0; r < config.repeticoes; r++) {
+                string saidaProcesso;
+                Execucao execucao = RodarComando(comando, config.timeout, saidaProcesso);
+                execucao.instancia = instancia;
+                execucao.solver = solver.nome;
+                execucao.repeticao = r;
+                ExtrairMetricas(saidaProcesso, execucao);
+                execucoes.push_back(execucao);
+                cout << instancia << " " << solver.nome << " #" << r << ": "
+                     << fixed << setprecision(3) << execucao.tempo << " s, custo " << execucao.custo
+                     << (execucao.estourouTempo ? " (timeout)" : (execucao.ok ? "" : " (falhou)")) << endl;
+                auto esperado = esperados.custos.find(instancia);
+                if (execucao.ok && esperados.solvers.count(solver.nome) && esperado != esperados.custos.end()
+                    && execucao.custo != esperado->second) {
+                    cout << "  REGRESSAO: custo esperado " << esperado->second << endl;
+                    regressoes++;
+                }
+                // se estourou o tempo não adianta repetir: as próximas também vão estourar
+                if (execucao.estourouTempo) {
+                    break;
+                }
+            }
+        }
+    }
+
+    EscreverResultados(config, versao, execucoes);
+    if (regressoes > 0) {
+        cout << regressoes << " execucoes com custo diferente do esperado (" << config.arquivoEsperados << ")" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+bool LerConfig(int argc, char* argv[], Config &config) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string valor = argv[++i];
+        if (arg == "--instancias") {
+            config.arquivoInstancias = valor;
+        } else if (arg == "--solvers") {
+            config.arquivoSolvers = valor;
+        } else if (arg == "--repeticoes") {
+            config.repeticoes = stoi(valor);
+        } else if (arg == "--aquecimento") {
+            config.aquecimento = stoi(valor);
+        } else if (arg == "--timeout") {
+            config.timeout = stod(valor);
+        } else if (arg == "--saida") {
+            config.saida = valor;
+        } else if (arg == "--solver") {
+            config.filtroSolver = valor;
+        } else if (arg == "--gerador") {
+            config.gerador = valor;
+        } else if (arg == "--esperados") {
+            config.arquivoEsperados = valor;
+        } else {
+            return false;
+        }
+    }
+    return config.repeticoes > 0;
+}
+
+// Formato: linhas em branco e comentários (#) são ignorados, a linha "versao X" identifica o conjunto,
+// "gerar <caminho> <parâmetros do gerador...>" (re)gera a instância com a semente fixada nos parâmetros
+// e cada uma das outras linhas é o caminho de uma instância já existente
+bool LerInstancias(string file, const string& gerador, string &versao, vector<string> &instancias) {
+    ifstream arquivo(file);
+    if (!arquivo.is_open()) {
+        return false;
+    }
+    versao = "?";
+    string linha;
+    while (getline(arquivo, linha)) {
+        stringstream ss(linha);
+        string primeiro;
+        if (!(ss >> primeiro) || primeiro[0] == '#') {
+            continue;
+        }
+        if (primeiro == "versao") {
+            ss >> versao;
+        } else if (primeiro == "gerar") {
+            string caminho, parametros;
+            ss >> caminho;
+            getline(ss, parametros);
+            string comando = gerador + " " + parametros + " --saida " + caminho;
+            size_t barra = caminho.rfind('/');
+            if (barra != string::npos) {
+                comando = "mkdir -p " + caminho.substr(0, barra) + " && " + comando;
+            }
+            if (system(comando.c_str()) != 0) {
+                cout << "Erro ao gerar a instância: " << comando << endl;
+                return false;
+            }
+            instancias.push_back(caminho);
+        } else {
+            instancias.push_back(primeiro);
+        }
+    }
+    return !instancias.empty();
+}
+
+// Formato: "<nome> <comando...>", o comando é passado para o sh e pode usar mpirun, variáveis de ambiente, etc.
+bool LerSolvers(string file, vector<Solver> &solvers) {
+    ifstream arquivo(file);
+    if (!arquivo.is_open()) {
+        return false;
+    }
+    string linha;
+    while (getline(arquivo, linha)) {
+        stringstream ss(linha);
+        Solver solver;
+        if (!(ss >> solver.nome) || solver.nome[0] == '#') {
+            continue;
+        }
+        getline(ss, solver.comando);
+        solver.comando.erase(0, solver.comando.find_first_not_of(" \t"));
+        if (!solver.comando.empty()) {
+            solvers.push_back(solver);
+        }
+    }
+    return !solvers.empty();
+}
+
+// Formato: "solvers <nome...>" lista os solvers conferidos e cada outra linha é "<instância> <custo>", com a
+// instância escrita como em instancias.txt
+bool LerEsperados(string file, Esperados &esperados) {
+    ifstream arquivo(file);
+    if (!arquivo.is_open()) {
+        return false;
+    }
+    string linha;
+    while (getline(arquivo, linha)) {
+        stringstream ss(linha);
+        string primeiro;
+        if (!(ss >> primeiro) || primeiro[0] == '#') {
+            continue;
+        }
+        if (primeiro == "solvers") {
+            string nome;
+            while (ss >> nome) {
+                esperados.solvers.insert(nome);
+            }
+        } else if (!(ss >> esperados.custos[primeiro])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Roda o comando num processo filho (grupo de processos próprio, para que o timeout derrube também
+// os processos do mpirun) e captura a saída padrão. O pico de RSS vem do rusage do wait4, que no
+// Linux já inclui o maior RSS entre os descendentes que foram esperados.
+Execucao RodarComando(const string& comando, double timeout, string &saidaProcesso) {
+    Execucao execucao = {};
+    execucao.nos = -1;
+    execucao.rotas = -1;
+    execucao.custo = -1;
+
+    int canal[2];
+    if (pipe(canal) != 0) {
+        execucao.codigoSaida = -1;
+        return execucao;
+    }
+
+    auto inicio = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(canal[0]);
+        close(canal[1]);
+        execucao.codigoSaida = -1;
+        return execucao;
+    }
+    if (pid == 0) {
+        setpgid(0, 0);
+        dup2(canal[1], STDOUT_FILENO);
+        close(canal[0]);
+        close(canal[1]);
+        execl("/bin/sh", "sh", "-c", comando.c_str(), (char*) nullptr);
+        _exit(127);
+    }
+    // o pai também cria o grupo: se o tempo estourar antes de o filho rodar, kill(-pid) já encontra o grupo
+    setpgid(pid, pid);
+    close(canal[1]);
+
+    char buffer[4096];
+    while (true) {
+        double decorrido = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+        if (decorrido > timeout) {
+            execucao.estourouTempo = true;
+            kill(-pid, SIGKILL);
+            break;
+        }
+        pollfd pfd = {canal[0], POLLIN, 0};
+        int espera = (int) min(1000.0, (timeout - decorrido) * 1000.0) + 1;
+        if (poll(&pfd, 1, espera) > 0) {
+            ssize_t lidos = read(canal[0], buffer, sizeof(buffer));
+            if (lidos <= 0) {
+                break;
+            }
+            saidaProcesso.append(buffer, lidos);
+        }
+    }
+    close(canal[0]);
+
+    int status = 0;
+    rusage uso = {};
+    wait4(pid, &status, 0, &uso);
+    execucao.tempo = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    execucao.picoRssKb = uso.ru_maxrss;
+    execucao.codigoSaida = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    execucao.ok = !execucao.estourouTempo && execucao.codigoSaida == 0;
+    return execucao;
+}
+
+// Procura na saída dos solvers as linhas que eles já imprimem ("Rotas: ", "Menor custo: ", "Custo total: ")
+// e o contador de nós, quando o solver foi compilado com instrumentação
+void ExtrairMetricas(const string& saidaProcesso, Execucao &execucao) {
+    stringstream ss(saidaProcesso);
+    string linha;
+    long long ultimoCustoRota = -1;
+    while (getline(ss, linha)) {
+        size_t pos;
+        if (linha.rfind("Rotas: ", 0) == 0) {
+            execucao.rotas = atoll(linha.c_str() + 7);
+        } else if (linha.rfind("Menor custo: ", 0) == 0) {
+            execucao.custo = atoll(linha.c_str() + 13);
+        } else if (linha.rfind("Custo total: ", 0) == 0) {
+            execucao.custo = atoll(linha.c_str() + 13);
+        } else if (linha.rfind("Nos explorados: ", 0) == 0) {
+            execucao.nos = atoll(linha.c_str() + 16);
+        } else if ((pos = linha.find("com custo: ")) != string::npos) {
+            ultimoCustoRota = atoll(linha.c_str() + pos + 11);
+        }
+    }
+    // a heurística só imprime o custo da rota que construiu
+    if (execucao.custo < 0) {
+        execucao.custo = ultimoCustoRota;
+    }
+}
+
+// percentil pelo método do posto mais próximo
+double Percentil(vector<double> valores, double p) {
+    if (valores.empty()) {
+        return 0.0;
+    }
+    sort(valores.begin(), valores.end());
+    size_t posto = (size_t) max(1.0, ceil(p / 100.0 * valores.size()));
+    return valores[min(posto, valores.size()) - 1];
+}
+
+void EscreverResultados(const Config& config, const string& versao, const vector<Execucao>& execucoes) {
+    // execuções individuais, para quem quiser fazer outra análise depois
+    ofstream arquivoExecucoes(config.saida + "_execucoes.csv");
+    arquivoExecucoes << "instancia,solver,repeticao,ok,timeout,codigo_saida,tempo_s,pico_rss_kb,nos,rotas,custo\n";
+    for (const auto& e : execucoes) {
+        arquivoExecucoes << e.instancia << "," << e.solver << "," << e.repeticao << "," << e.ok << "," << e.estourouTempo << ","
+                         << e.codigoSaida << "," << fixed << setprecision(6) << e.tempo << "," << e.picoRssKb << ","
+                         << e.nos << "," << e.rotas << "," << e.custo << "\n";
+    }
+
+    // resumo por (instância, solver), mantendo a ordem em que foram executados
+    vector<pair<string, string>> chaves;
+    map<pair<string, string>, vector<const Execucao*>> grupos;
+    for (const auto& e : execucoes) {
+        auto chave = make_pair(e.instancia, e.solver);
+        if (grupos.find(chave) == grupos.end()) {
+            chaves.push_back(chave);
+        }
+        grupos[chave].push_back(&e);
+    }
+
+    char host[256] = "?";
+    gethostname(host, sizeof(host));
+
+    ofstream csv(config.saida + ".csv");
+    ofstream json(config.saida + ".json");
+    csv << "instancia,solver,execucoes,ok,mediana_s,p95_s,min_s,nos,rotas,pico_rss_kb,custo,custo_consistente\n";
+    json << "{\n  \"versao_instancias\": \"" << versao << "\",\n  \"host\": \"" << host << "\",\n"
+         << "  \"repeticoes\": " << config.repeticoes << ",\n  \"resultados\": [\n";
+
+    for (size_t k = 0; k < chaves.size(); k++) {
+        const auto& grupo = grupos[chaves[k]];
+        vector<double> tempos;
+        long picoRss = 0;
+        long long nos = -1, rotas = -1, custo = -1;
+        bool consistente = true;
+        for (const Execucao* e : grupo) {
+            picoRss = max(picoRss, e->picoRssKb);
+            if (!e->ok) {
+                continue;
+            }
+            tempos.push_back(e->tempo);
+            nos = e->nos;
+            rotas = e->rotas;
+            if (custo >= 0 && e->custo != custo) {
+                consistente = false;
+            }
+            custo = e->custo;
+        }
+        double mediana = Percentil(tempos, 50.0);
+        double p95 = Percentil(tempos, 95.0);
+        double minimo = tempos.empty() ? 0.0 : *min_element(tempos.begin(), tempos.end());
+
+        csv << chaves[k].first << "," << chaves[k].second << "," << grupo.size() << "," << tempos.size() << ","
+            << fixed << setprecision(6) << mediana << "," << p95 << "," << minimo << ","
+            << nos << "," << rotas << "," << picoRss << "," << custo << "," << consistente << "\n";
+        json << "    {\"instancia\": \"" << chaves[k].first << "\", \"solver\": \"" << chaves[k].second << "\", "
+             << "\"execucoes\": " << grupo.size() << ", \"ok\": " << tempos.size() << ", "
+             << "\"mediana_s\": " << mediana << ", \"p95_s\": " << p95 << ", \"min_s\": " << minimo << ", "
+             << "\"nos\": " << nos << ", \"rotas\": " << rotas << ", \"pico_rss_kb\": " << picoRss << ", "
+             << "\"custo\": " << custo << ", \"custo_consistente\": " << (consistente ? "true" : "false") << "}"
+             << (k + 1 < chaves.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+    cout << "Resultados em " << config.saida << ".csv, " << config.saida << ".json e " << config.saida << "_execucoes.csv" << endl;
+}
@@ -0,0 +1,274 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <charconv>
+#include <algorithm>
+
+using namespace std;
+
+// Gerador determinístico de instâncias no mesmo formato lido pelos solvers:
+//   N (número de nós, incluindo o depósito 0)
+//   N-1 linhas "id demanda"
+//   K (número de arestas)
+//   K linhas "origem destino custo"
+//   CAPACIDADE C (opcional, só quando --capacidade é passado; os solvers usam como capacidade dos veículos)
+// A mesma semente com os mesmos parâmetros gera sempre o mesmo arquivo, em qualquer máquina: o gerador
+// usa o seu próprio xoshiro256** e as suas próprias distribuições em vez das de <random>, que variam
+// entre implementações da biblioteca padrão.
+
+struct Parametros {
+    int clientes = 9;
+    uint64_t semente = 1;
+    double probAresta = 0.25;
+    bool simetrico = false;
+    string custos = "aleatorio";      // aleatorio | euclidiano
+    int custoMax = 100;
+    string distribuicao = "uniforme"; // uniforme | normal | bimodal
+    int demandaMin = 1;
+    int demandaMax = 10;
+    int capacidade = 0;               // 0 = não escreve a capacidade no arquivo
+    string saida;                     // vazio = saída padrão
+};
+
+class Aleatorio {
+    uint64_t s[4];
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    explicit Aleatorio(uint64_t semente) {
+        for (int i = 0; i < 4; i++) {
+            s[i] = splitmix64(semente);
+        }
+    }
+
+    uint64_t proximo() {
+        uint64_t resultado = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return resultado;
+    }
+
+    // real uniforme em [0, 1)
+    double real() {
+        return (proximo() >> 11) * 0x1.0p-53;
+    }
+
+    // inteiro uniforme em [a, b], sem viés (rejeição)
+    int inteiro(int a, int b) {
+        uint64_t faixa = (uint64_t) (b - a) + 1;
+        uint64_t limite = UINT64_MAX - UINT64_MAX % faixa;
+        uint64_t x;
+        do {
+            x = proximo();
+        } while (x >= limite);
+        return a + (int) (x % faixa);
+    }
+
+    double normal(double media, double desvio) {
+        double u1 = real(), u2 = real();
+        return media + desvio * sqrt(-2.0 * log(1.0 - u1)) * cos(2.0 * M_PI * u2);
+    }
+};
+
+bool LerParametros(int argc, char* argv[], Parametros &p);
+vector<int> GerarDemandas(const Parametros& p, Aleatorio& rng);
+void EscreverInteiro(string& buffer, long long valor, char separador);
+
+int main(int argc, char* argv[]){
+    Parametros p;
+    if (!LerParametros(argc, argv, p)) {
+        cout << "Usage: " << argv[0] << " --clientes N [--semente S] [--prob-aresta P] [--simetrico]"
+             << " [--custos aleatorio|euclidiano] [--custo-max C] [--distribuicao uniforme|normal|bimodal]"
+             << " [--demanda-min D] [--demanda-max D] [--capacidade Q] [--saida arquivo]" << endl;
+        return 1;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    Aleatorio rng(p.semente);
+    int N = p.clientes + 1;
+
+    // coordenadas só são usadas no modo euclidiano, mas são sempre sorteadas para que trocar o tipo de
+    // custo não mude as demandas sorteadas
+    vector<double> x(N), y(N);
+    for (int i = 0; i < N; i++) {
+        x[i] = rng.real() * p.custoMax;
+        y[i] = rng.real() * p.custoMax;
+    }
+    vector<int> demanda = GerarDemandas(p, rng);
+
+    auto custo = [&](int i, int j) {
+        if (p.custos == "euclidiano") {
+            return max(1, (int) lround(hypot(x[i] - x[j], y[i] - y[j])));
+        }
+        return rng.inteiro(1, p.custoMax);
+    };
+
+    // as arestas vão para um buffer porque K precisa ser escrito antes delas
+    string arestas;
+    arestas.reserve((size_t) min<double>(1e9, 16.0 * (2.0 * p.clientes + p.probAresta * p.clientes * p.clientes)));
+    long long K = 0;
+
+    // assim como no gerador do relatório, o depósito sempre tem ida e volta para todos os clientes
+    for (int i = 1; i < N; i++) {
+        int c = custo(0, i);
+        EscreverInteiro(arestas, 0, ' '); EscreverInteiro(arestas, i, ' '); EscreverInteiro(arestas, c, '\n');
+        EscreverInteiro(arestas, i, ' '); EscreverInteiro(arestas, 0, ' '); EscreverInteiro(arestas, c, '\n');
+        K += 2;
+    }
+
+    // entre clientes, cada par i < j existe com probabilidade P. Em vez de sortear um número por par,
+    // sorteamos o tamanho do salto até o próximo par escolhido (distribuição geométrica), o que deixa
+    // a geração proporcional ao número de arestas e não ao número de pares
+    long long totalPares = (long long) p.clientes * (p.clientes - 1) / 2;
+    long long par = -1;
+    // log1p não arredonda para 0 com P muito pequeno (log(1 - P) arredondaria e o salto viraria inf)
+    double logQ = p.probAresta < 1.0 ? log1p(-p.probAresta) : 0.0;
+    int i = 1, j = 1;
+    long long inicioLinha = 0; // índice do par (i, i+1)
+    while (p.probAresta > 0.0) {
+        if (p.probAresta >= 1.0) {
+            par += 1;
+        } else {
+            // com P pequeno o salto pode passar de qualquer long long; acima do total de pares ele só encerra o laço
+            double salto = floor(log1p(-rng.real()) / logQ);
+            par += 1 + (long long) min(salto, (double) totalPares);
+        }
+        if (par >= totalPares) {
+            break;
+        }
+        // converte o índice linear do par para (i, j) avançando as linhas
+        while (par >= inicioLinha + (p.clientes - i)) {
+            inicioLinha += p.clientes - i;
+            i++;
+        }
+        j = i + 1 + (int) (par - inicioLinha);
+        int c = custo(i, j);
+        EscreverInteiro(arestas, i, ' '); EscreverInteiro(arestas, j, ' '); EscreverInteiro(arestas, c, '\n');
+        K++;
+        if (p.simetrico) {
+            EscreverInteiro(arestas, j, ' '); EscreverInteiro(arestas, i, ' '); EscreverInteiro(arestas, c, '\n');
+            K++;
+        }
+    }
+
+    FILE* arquivo = p.saida.empty() ? stdout : fopen(p.saida.c_str(), "w");
+    if (arquivo == nullptr) {
+        cerr << "Erro ao abrir o arquivo de saída: " << p.saida << endl;
+        return 1;
+    }
+    string cabecalho;
+    EscreverInteiro(cabecalho, N, '\n');
+    for (int k = 1; k < N; k++) {
+        EscreverInteiro(cabecalho, k, ' ');
+        EscreverInteiro(cabecalho, demanda[k], '\n');
+    }
+    EscreverInteiro(cabecalho, K, '\n');
+    fwrite(cabecalho.data(), 1, cabecalho.size(), arquivo);
+    fwrite(arestas.data(), 1, arestas.size(), arquivo);
+    if (p.capacidade > 0) {
+        fprintf(arquivo, "CAPACIDADE %d\n", p.capacidade);
+    }
+    if (arquivo != stdout) {
+        fclose(arquivo);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    cerr << "Nos: " << N << " Arestas: " << K << " Tempo de geração: " << duration.count() << " segundos" << endl;
+    return 0;
+}
+
+bool LerParametros(int argc, char* argv[], Parametros &p) {
+    bool temClientes = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--simetrico") {
+            p.simetrico = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string valor = argv[++i];
+        if (arg == "--clientes") {
+            p.clientes = stoi(valor);
+            temClientes = true;
+        } else if (arg == "--semente") {
+            p.semente = stoull(valor);
+        } else if (arg == "--prob-aresta") {
+            p.probAresta = stod(valor);
+        } else if (arg == "--custos") {
+            p.custos = valor;
+        } else if (arg == "--custo-max") {
+            p.custoMax = stoi(valor);
+        } else if (arg == "--distribuicao") {
+            p.distribuicao = valor;
+        } else if (arg == "--demanda-min") {
+            p.demandaMin = stoi(valor);
+        } else if (arg == "--demanda-max") {
+            p.demandaMax = stoi(valor);
+        } else if (arg == "--capacidade") {
+            p.capacidade = stoi(valor);
+        } else if (arg == "--saida") {
+            p.saida = valor;
+        } else {
+            return false;
+        }
+    }
+    if (p.custos != "aleatorio" && p.custos != "euclidiano") {
+        return false;
+    }
+    if (p.distribuicao != "uniforme" && p.distribuicao != "normal" && p.distribuicao != "bimodal") {
+        return false;
+    }
+    return temClientes && p.clientes >= 1 && p.custoMax >= 1 && p.demandaMin >= 1 && p.demandaMin <= p.demandaMax
+           && p.probAresta >= 0.0 && p.probAresta <= 1.0;
+}
+
+// Demandas em [demandaMin, demandaMax] (e nunca acima da capacidade, quando ela é informada, para que
+// todo cliente caiba em pelo menos uma rota). A distribuição bimodal mistura muitos clientes pequenos com
+// alguns grandes, o que deixa poucas rotas com muitos clientes e torna a busca bem mais difícil.
+vector<int> GerarDemandas(const Parametros& p, Aleatorio& rng) {
+    int limite = p.capacidade > 0 ? min(p.demandaMax, p.capacidade) : p.demandaMax;
+    int minimo = min(p.demandaMin, limite);
+    vector<int> demanda(p.clientes + 1, 0);
+    for (int i = 1; i <= p.clientes; i++) {
+        int d;
+        if (p.distribuicao == "normal") {
+            double media = (minimo + limite) / 2.0;
+            d = (int) lround(rng.normal(media, (limite - minimo) / 6.0 + 0.5));
+        } else if (p.distribuicao == "bimodal") {
+            int corte = minimo + (limite - minimo) / 4;
+            d = rng.real() < 0.8 ? rng.inteiro(minimo, corte) : rng.inteiro(limite - (limite - minimo) / 4, limite);
+        } else {
+            d = rng.inteiro(minimo, limite);
+        }
+        demanda[i] = min(limite, max(minimo, d));
+    }
+    return demanda;
+}
+
+void EscreverInteiro(string& buffer, long long valor, char separador) {
+    char texto[24];
+    auto resultado = to_chars(texto, texto + sizeof(texto), valor);
+    buffer.append(texto, resultado.ptr);
+    buffer.push_back(separador);
+}
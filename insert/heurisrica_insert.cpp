@@ -2,128 +2,219 @@
 #include <vector>
 #include <fstream>
 #include <string>
-#include <map>
 #include <algorithm>
 #include <climits>
-#include <set>
+#include <queue>
+#include <tuple>
+#include <chrono>
 
 using namespace std;
 
+// Heurística de inserção por arrependimento (regret-k) com várias rotas e capacidade.
+//
+// A cada passo o cliente escolhido é o que mais perde se não for inserido agora: para cada cliente fora das
+// rotas guardamos as k melhores opções de inserção (a melhor posição em cada rota aberta, mais a opção de abrir
+// uma rota só para ele) e o arrependimento é a soma das diferenças entre a 2a..k-ésima opção e a melhor. O
+// cliente de maior arrependimento entra na sua melhor opção. Clientes sem posição em nenhuma rota aberta só
+// abrem uma rota nova quando nenhum outro cabe numa rota aberta, começando pelo mais longe do depósito.
+//
+// Para escalar a milhares de clientes:
+//  - as posições consideradas para um cliente são as vizinhas (antes ou depois) dos seus --vizinhos clientes
+//    mais próximos (lista granular); com o grafo esparso gerado para instâncias grandes, só elas existem;
+//  - as opções de cada cliente ficam guardadas e só são recalculadas quando a última inserção as afeta: quem
+//    tem o cliente inserido ou os seus dois vizinhos na rota como vizinho próximo (posições novas ou
+//    destruídas) e quem tinha entre as suas opções a rota que mudou de carga;
+//  - a escolha usa uma fila de prioridade preguiçosa: cada recálculo empilha uma entrada nova e as entradas
+//    de versões anteriores são descartadas quando chegam ao topo.
+
+const int SEM_ARESTA = INT_MAX;
+
 class Grafo {
-    unordered_map<int, vector<pair<int, int>>> grafo_classe;
+    int n = 0;
+    vector<tuple<int, int, int>> arestas; // na ordem do arquivo, até finalizar()
+    // arestas de saída e de entrada de cada nó (outro nó, custo), ordenadas pelo outro nó
+    vector<int> inicioSaida, inicioEntrada;
+    vector<pair<int, int>> saida, entrada;
 
 public:
     // Função para adicionar uma aresta ao grafo
     void adicionarAresta(int origem, int destino, int peso) {
-        grafo_classe[origem].push_back(make_pair(destino, peso));
-    }
-
-    // função para calcular custo de uma rota
-    int calcularCustoRota(const vector<int>& rota) {
-        // copia de rota
-        vector<int> rota_copia = rota;
-        rota_copia.push_back(0);
-        rota_copia.insert(rota_copia.begin(), 0);
-        int custo = 0;
-        for (int i = 0; i < rota_copia.size() - 1; i++) {
-            int origem = rota_copia[i];
-            int destino = rota_copia[i + 1];
-
-            for (const auto& aresta : grafo_classe[origem]) {
-                if (aresta.first == destino) {
-                    custo += aresta.second;
-                    break;
-                }
-            }
-        }
-
-        return custo;
+        arestas.push_back(make_tuple(origem, destino, peso));
     }
 
-    int calcularCustoRotaIsolado(const vector<int>& rota) {
-        vector<int> rota_copia = rota;
-        int custo = 0;
-        for (int i = 0; i < rota_copia.size() - 1; i++) {
-            int origem = rota_copia[i];
-            int destino = rota_copia[i + 1];
-            for (const auto& aresta : grafo_classe[origem]) {
-                if (aresta.first == destino) {
-                    custo += aresta.second;
-                    break;
-                }
+    // Monta as listas de adjacência; entre dois nós vale a primeira aresta do arquivo
+    void finalizar(int numNos) {
+        n = numNos;
+        stable_sort(arestas.begin(), arestas.end(), [](const tuple<int, int, int>& a, const tuple<int, int, int>& b) {
+            return make_pair(get<0>(a), get<1>(a)) < make_pair(get<0>(b), get<1>(b));
+        });
+        arestas.erase(unique(arestas.begin(), arestas.end(), [](const tuple<int, int, int>& a, const tuple<int, int, int>& b) {
+            return get<0>(a) == get<0>(b) && get<1>(a) == get<1>(b);
+        }), arestas.end());
+        inicioSaida.assign(n + 1, 0);
+        inicioEntrada.assign(n + 1, 0);
+        for (const auto& aresta : arestas) {
+            if (get<0>(aresta) < n && get<1>(aresta) < n) {
+                inicioSaida[get<0>(aresta) + 1]++;
+                inicioEntrada[get<1>(aresta) + 1]++;
             }
         }
-
-        return custo;
+        for (int i = 0; i < n; i++) {
+            inicioSaida[i + 1] += inicioSaida[i];
+            inicioEntrada[i + 1] += inicioEntrada[i];
+        }
+        saida.resize(inicioSaida[n]);
+        entrada.resize(inicioEntrada[n]);
+        vector<int> posSaida(inicioSaida.begin(), inicioSaida.end() - 1), posEntrada(inicioEntrada.begin(), inicioEntrada.end() - 1);
+        // as arestas estão ordenadas por (origem, destino), então as entradas de cada nó também saem ordenadas
+        for (const auto& aresta : arestas) {
+            int origem = get<0>(aresta), destino = get<1>(aresta), peso = get<2>(aresta);
+            if (origem < n && destino < n) {
+                saida[posSaida[origem]++] = make_pair(destino, peso);
+                entrada[posEntrada[destino]++] = make_pair(origem, peso);
+            }
+        }
+        vector<tuple<int, int, int>>().swap(arestas);
     }
 
+    int numNos() const {
+        return n;
+    }
 
-    // Função para verificar se uma rota é válida
-    bool verificarRotaValida(const vector<int>& rota) {
-        for (int i = 0; i < rota.size() - 1; i++) {
-            int origem = rota[i];
-            int destino = rota[i + 1];
+    // Custo da aresta origem -> destino, ou SEM_ARESTA
+    int custo(int origem, int destino) const {
+        auto fim = saida.begin() + inicioSaida[origem + 1];
+        auto it = lower_bound(saida.begin() + inicioSaida[origem], fim, make_pair(destino, INT_MIN));
+        return it != fim && it->first == destino ? it->second : SEM_ARESTA;
+    }
 
-            // Verifica se há uma aresta entre os vértices da rota
-            if (grafo_classe.find(origem) == grafo_classe.end()) {
-                return false;
-            }
+    // Custo de uma rota saindo e voltando ao depósito 0; aresta que não existe soma 0
+    long long calcularCustoRota(const vector<int>& rota) const {
+        long long total = 0;
+        int anterior = 0;
+        for (size_t i = 0; i <= rota.size(); i++) {
+            int proximo = i < rota.size() ? rota[i] : 0;
+            int aresta = custo(anterior, proximo);
+            total += aresta != SEM_ARESTA ? aresta : 0;
+            anterior = proximo;
+        }
+        return total;
+    }
 
-            bool arestaEncontrada = false;
-            for (const auto& aresta : grafo_classe[origem]) {
-                if (aresta.first == destino) {
-                    arestaEncontrada = true;
-                    break;
-                }
+    // Os "limite" clientes ligados a "no" (em qualquer sentido) pela aresta mais barata
+    vector<int> vizinhosMaisProximos(int no, int limite) const {
+        vector<pair<int, int>> candidatos; // (custo, cliente)
+        for (int i = inicioSaida[no]; i < inicioSaida[no + 1]; i++) {
+            candidatos.push_back(make_pair(saida[i].second, saida[i].first));
+        }
+        for (int i = inicioEntrada[no]; i < inicioEntrada[no + 1]; i++) {
+            candidatos.push_back(make_pair(entrada[i].second, entrada[i].first));
+        }
+        sort(candidatos.begin(), candidatos.end());
+        vector<int> vizinhos;
+        for (const auto& c : candidatos) {
+            if ((int) vizinhos.size() == limite) {
+                break;
             }
-
-            if (!arestaEncontrada) {
-                return false;
+            if (c.second == 0 || c.second == no || find(vizinhos.begin(), vizinhos.end(), c.second) != vizinhos.end()) {
+                continue;
             }
+            vizinhos.push_back(c.second);
         }
-
-        return true;
+        return vizinhos;
     }
 };
 
-void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, vector<int> &locais, Grafo &grafo);
-vector<vector<int>> GerarTodasAsCombinacoes(const vector<int> locais, map<int,int> demanda, int capacidade, Grafo &grafo);
-bool VerificarCapacidade(vector<int> rota, map<int,int> demanda, int capacidade);
-vector<int> insertMaisProximo( vector<int>& rotas , Grafo& grafo);
+struct ParametrosInsercao {
+    int capacidade = -1; // -1 = linha CAPACIDADE do arquivo e, sem ela, 15
+    int regret = 3;      // k: opções comparadas no arrependimento (1 = inserção mais barata)
+    int vizinhos = 30;   // clientes próximos cujas posições vizinhas são testadas
+};
+
+struct SolucaoInsercao {
+    vector<vector<int>> rotas;
+    vector<int> carga;
+    vector<int> semRota; // clientes que não cabem em rota nenhuma (demanda acima da capacidade ou sem arestas)
+    long long custo = 0;
+};
+
+bool LerParametros(int argc, char* argv[], string& file, ParametrosInsercao& p);
+void LerGrafo(string file, vector<int> &demanda, vector<int> &locais, Grafo &grafo, int &capacidade);
+SolucaoInsercao InsercaoRegret(const vector<int>& locais, const vector<int>& demanda, int capacidade, const Grafo& grafo,
+                               int k, int numVizinhos);
 
 int main(int argc, char* argv[]){
-    string file = argv[1];
-    int capacidade = 15;
-    Grafo grafo;    
-    map<int,int> demanda;
-    vector<tuple<int, int , int>> arestas;
+    auto start = std::chrono::high_resolution_clock::now();
+    string file;
+    ParametrosInsercao parametros;
+    if (!LerParametros(argc, argv, file, parametros)) {
+        cout << "Usage: " << argv[0] << " <file> [--capacidade C] [--regret K] [--vizinhos L]" << endl;
+        return 1;
+    }
+    Grafo grafo;
+    vector<int> demanda;
     vector<int> locais;
     // Realiza a leitura do grafo
-    LerGrafo(file, demanda, arestas, locais, grafo);
+    LerGrafo(file, demanda, locais, grafo, parametros.capacidade);
+    if (parametros.capacidade < 0) {
+        parametros.capacidade = 15;
+    }
 
     cout << "Local: "  << locais.size() << endl;
-    vector<vector<int>> rotas = GerarTodasAsCombinacoes(locais, demanda, capacidade, grafo);
-    cout << "Rotas: " << rotas.size() << endl;
-    int melhorCusto = INT_MAX;
-
-    vector<int> melhorRota;
-    melhorRota = insertMaisProximo(locais, grafo);
-        // Imprimir o resultado
+    SolucaoInsercao solucao = InsercaoRegret(locais, demanda, parametros.capacidade, grafo, parametros.regret, parametros.vizinhos);
+    cout << "Rotas construidas: " << solucao.rotas.size() << endl;
+    // Imprimir o resultado
     cout << "Melhor Rotas:" << endl;
-    for (const auto& rota : melhorRota) {
-        cout  << rota << " ";
+    for (const auto& rota : solucao.rotas) {
+        cout << 0;
+        for (int cidade : rota) {
+            cout << " " << cidade;
+        }
+        cout << " 0" << endl;
+    }
+    cout << " com custo: " << solucao.custo << endl;
+    if (!solucao.semRota.empty()) {
+        cout << "Clientes sem rota:";
+        for (int cidade : solucao.semRota) {
+            cout << " " << cidade;
+        }
+        cout << endl;
     }
-    cout << " com custo: " << grafo.calcularCustoRota(melhorRota) << endl;
 
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Tempo de execução: " << duration.count() << " segundos" << std::endl;
     return 0;
 }
 
-void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>> &arestas, vector<int> &locais, Grafo &grafo) {
+bool LerParametros(int argc, char* argv[], string& file, ParametrosInsercao& p) {
+    if (argc < 2 || argc % 2 != 0) {
+        return false;
+    }
+    file = argv[1];
+    for (int i = 2; i < argc; i += 2) {
+        string opcao = argv[i];
+        int valor = atoi(argv[i + 1]);
+        if (opcao == "--capacidade") {
+            p.capacidade = valor;
+        } else if (opcao == "--regret") {
+            p.regret = valor;
+        } else if (opcao == "--vizinhos") {
+            p.vizinhos = valor;
+        } else {
+            return false;
+        }
+    }
+    return p.regret >= 1 && p.vizinhos >= 1;
+}
+
+void LerGrafo(string file, vector<int> &demanda, vector<int> &locais, Grafo &grafo, int &capacidade) {
     ifstream arquivo;
     arquivo.open(file);
     if (arquivo.is_open()) {
         int N; // número de locais a serem visitados
         arquivo >> N;
+        demanda.assign(N, 0);
         N -= 1;
         for (int i = 1; i <= N; i++) {
             locais.push_back(i);
@@ -133,7 +224,9 @@ void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>>
             int id_no, demanda_no;
             arquivo >> id_no;
             arquivo >> demanda_no;
-            demanda[id_no] = demanda_no;
+            if (id_no > 0 && id_no <= N) {
+                demanda[id_no] = demanda_no;
+            }
         }
         // número de aresyas
         int K; // Declare a variável K antes de utilizá-la
@@ -145,87 +238,215 @@ void LerGrafo(string file, map<int,int> &demanda, vector<tuple<int, int , int>>
             arquivo >> id_no1;
             arquivo >> id_no2;
             arquivo >> custo;
-            arestas.push_back(make_tuple(id_no1, id_no2, custo));
             grafo.adicionarAresta(id_no1, id_no2, custo);
         }
+        // linhas opcionais "CHAVE valor" depois das arestas; só a capacidade interessa aqui
+        string chave;
+        int valor;
+        while (arquivo >> chave >> valor) {
+            if (chave == "CAPACIDADE" && capacidade < 0) {
+                capacidade = valor;
+            }
+        }
+        grafo.finalizar(N + 1);
     }
     arquivo.close();
 }
 
-bool VerificarCapacidade(vector<int> rota, map<int,int> demanda, int capacidade){
-    int demanda_total = 0;
-    for (auto& local : rota){
-        demanda_total += demanda[local];
+// Opção de inserção de um cliente: na rota "rota" logo depois de "anterior" (0 = início da rota), ou numa rota
+// nova (rota -1). "custo" é o aumento do custo total.
+struct Insercao {
+    long long custo;
+    int rota;
+    int anterior;
+};
+
+// Entrada da fila: maior classe (1 = cabe numa rota aberta), depois maior chave (arrependimento, ou o custo da
+// rota nova na classe 0). Empates pelo menor cliente, para o resultado não depender da fila.
+struct EntradaFila {
+    int classe;
+    long long chave;
+    int cliente;
+    int versao;
+
+    bool operator<(const EntradaFila& o) const {
+        if (classe != o.classe) {
+            return classe < o.classe;
+        }
+        if (chave != o.chave) {
+            return chave < o.chave;
+        }
+        return cliente > o.cliente;
     }
-    return demanda_total <= capacidade;
-}
+};
 
-// Função para gerar todas as combinações possíveis
-vector<vector<int>> GerarTodasAsCombinacoes(const vector<int> locais, map<int,int> demanda, int capacidade,Grafo &grafo) {
-    vector<vector<int>> rotas;
-    int n = locais.size();
-    for (int i = 1; i < (1 << n); i++) {
-        vector<int> rota;
-        for (int j = 0; j < n; j++) {
-            if (i & (1 << j)) {
-                rota.push_back(locais[j]);
+// Função para construir as rotas com a heurística de inserção por arrependimento
+SolucaoInsercao InsercaoRegret(const vector<int>& locais, const vector<int>& demanda, int capacidade, const Grafo& grafo,
+                               int k, int numVizinhos) {
+    int n = grafo.numNos();
+    // rotas como listas ligadas pelos clientes; 0 nas pontas é o depósito
+    vector<int> proximo(n, 0), anterior(n, 0), rotaDe(n, -1);
+    vector<int> primeiro, carga;
+
+    vector<vector<int>> vizinhos(n), reversos(n);
+    vector<long long> custoNovaRota(n, -1);
+    for (int u : locais) {
+        vizinhos[u] = grafo.vizinhosMaisProximos(u, numVizinhos);
+        for (int a : vizinhos[u]) {
+            reversos[a].push_back(u);
+        }
+        int ida = grafo.custo(0, u), volta = grafo.custo(u, 0);
+        if (demanda[u] <= capacidade && ida != SEM_ARESTA && volta != SEM_ARESTA) {
+            custoNovaRota[u] = (long long) ida + volta;
+        }
+    }
+
+    vector<vector<Insercao>> opcoes(n);
+    vector<int> versao(n, 0);
+    vector<vector<int>> inscritos; // por rota: clientes que a tinham entre as opções ao serem recalculados
+    priority_queue<EntradaFila> fila;
+    // melhor posição de cada rota no recálculo atual (marcada pelo número do recálculo)
+    vector<Insercao> melhorNaRota;
+    vector<int> marcaRota;
+    vector<int> rotasVistas;
+    int recalculos = 0;
+
+    auto recalcular = [&](int u) {
+        recalculos++;
+        rotasVistas.clear();
+        auto considerar = [&](int r, int p, int s) {
+            int ida = grafo.custo(p, u), volta = grafo.custo(u, s);
+            if (ida == SEM_ARESTA || volta == SEM_ARESTA) {
+                return;
+            }
+            long long delta = (long long) ida + volta - grafo.custo(p, s);
+            if (marcaRota[r] != recalculos) {
+                marcaRota[r] = recalculos;
+                melhorNaRota[r] = {delta, r, p};
+                rotasVistas.push_back(r);
+            } else if (delta < melhorNaRota[r].custo) {
+                melhorNaRota[r] = {delta, r, p};
             }
+        };
+        for (int a : vizinhos[u]) {
+            int r = rotaDe[a];
+            if (r < 0 || carga[r] + demanda[u] > capacidade) {
+                continue;
+            }
+            considerar(r, anterior[a], a);
+            considerar(r, a, proximo[a]);
+        }
+        vector<Insercao>& lista = opcoes[u];
+        lista.clear();
+        for (int r : rotasVistas) {
+            lista.push_back(melhorNaRota[r]);
+        }
+        int classe = lista.empty() ? 0 : 1;
+        if (custoNovaRota[u] >= 0) {
+            lista.push_back({custoNovaRota[u], -1, 0});
+        }
+        auto maisBarata = [](const Insercao& a, const Insercao& b) {
+            return a.custo != b.custo ? a.custo < b.custo : a.rota < b.rota;
+        };
+        if ((int) lista.size() > k) {
+            partial_sort(lista.begin(), lista.begin() + k, lista.end(), maisBarata);
+            lista.resize(k);
+        } else {
+            sort(lista.begin(), lista.end(), maisBarata);
         }
-        if (VerificarCapacidade(rota, demanda, capacidade)){
-            
-            // rota.push_back(0);
-            if (grafo.verificarRotaValida(rota)){
-                rotas.push_back(rota);
+        versao[u]++;
+        if (lista.empty()) {
+            return;
+        }
+        long long chave = 0;
+        if (classe == 0) {
+            chave = lista[0].custo;
+        } else if (k == 1) {
+            chave = -lista[0].custo;
+        } else {
+            for (size_t i = 1; i < lista.size(); i++) {
+                chave += lista[i].custo - lista[0].custo;
+            }
+        }
+        fila.push({classe, chave, u, versao[u]});
+        for (const Insercao& op : lista) {
+            if (op.rota >= 0) {
+                inscritos[op.rota].push_back(u);
             }
         }
+    };
+
+    for (int u : locais) {
+        recalcular(u);
     }
-    return rotas;
-}
 
-// Função para gerar uma rota usando a heuristica de inserção da rota mais próxima
-vector<int> insertMaisProximo( vector<int>& rotas , Grafo& grafo) {
-    vector<int> rotaHeuristica;
-    rotaHeuristica.push_back(0);
-    rotas.push_back(0);
-
-
-    int cidadeAtual = rotaHeuristica.back();
-    // loop para encontrar a rota mais próxima, até passar por todas as cidades
-    while (rotas.size() > 1) {
-        cout << "Cidade Atual: " << cidadeAtual << endl;
-        int cidadeMaisProxima = -1;
-        int menorCusto = INT_MAX;
-        // loop para encontrar a cidade mais próxima com o menor custo
-
-        for (int local : rotas) {
-            cout << "Local atual " << local << endl;
-            vector<int> rotaAtual = {cidadeAtual, local};
-            int custo = grafo.calcularCustoRotaIsolado(rotaAtual);
-            cout << "Para a rotas: " << cidadeAtual << " -> " << local << " o custo é: " << custo << endl;
-            if (custo == 0){
-                custo = INT_MAX;
+    vector<int> marcaAfetado(n, 0);
+    int insercoes = 0;
+    while (!fila.empty()) {
+        EntradaFila topo = fila.top();
+        fila.pop();
+        int u = topo.cliente;
+        if (rotaDe[u] >= 0 || topo.versao != versao[u]) {
+            continue;
+        }
+        Insercao escolha = opcoes[u][0];
+        int r = escolha.rota, p = escolha.anterior, s;
+        if (r < 0) {
+            r = primeiro.size();
+            primeiro.push_back(u);
+            carga.push_back(0);
+            inscritos.emplace_back();
+            melhorNaRota.emplace_back();
+            marcaRota.push_back(0);
+            p = s = 0;
+        } else {
+            s = p == 0 ? primeiro[r] : proximo[p];
+            if (p == 0) {
+                primeiro[r] = u;
+            } else {
+                proximo[p] = u;
             }
-            if (custo < menorCusto) {
-                menorCusto = custo;
-                cidadeMaisProxima = local;
-                
+            if (s != 0) {
+                anterior[s] = u;
             }
         }
-        if (cidadeMaisProxima == -1){
-
+        anterior[u] = p;
+        proximo[u] = s;
+        rotaDe[u] = r;
+        carga[r] += demanda[u];
+        opcoes[u].clear();
+
+        // só quem tinha a rota r entre as opções ou tem u, p ou s entre os vizinhos pode ter mudado
+        insercoes++;
+        vector<int> afetados;
+        afetados.swap(inscritos[r]);
+        for (int no : {u, p, s}) {
+            if (no != 0) {
+                afetados.insert(afetados.end(), reversos[no].begin(), reversos[no].end());
+            }
         }
-        cidadeAtual = cidadeMaisProxima;
-        rotaHeuristica.push_back(cidadeMaisProxima);
-        // remove a cidade da lista de cidades, para que não passe novamente por ela    
-        if (cidadeMaisProxima != 0) {
-            rotas.erase(find(rotas.begin(), rotas.end(), cidadeMaisProxima));
+        for (int w : afetados) {
+            if (rotaDe[w] < 0 && marcaAfetado[w] != insercoes) {
+                marcaAfetado[w] = insercoes;
+                recalcular(w);
+            }
         }
     }
 
-    rotaHeuristica.push_back(0);
-
-    return rotaHeuristica;
-
-    // return rota;
+    SolucaoInsercao solucao;
+    for (size_t r = 0; r < primeiro.size(); r++) {
+        vector<int> rota;
+        for (int c = primeiro[r]; c != 0; c = proximo[c]) {
+            rota.push_back(c);
+        }
+        solucao.custo += grafo.calcularCustoRota(rota);
+        solucao.rotas.push_back(rota);
+        solucao.carga.push_back(carga[r]);
+    }
+    for (int u : locais) {
+        if (rotaDe[u] < 0) {
+            solucao.semRota.push_back(u);
+        }
+    }
+    return solucao;
 }
-